@@ -0,0 +1,66 @@
+#!/bin/bash
+#
+# Send an image to `QSPI Config Memory Programming` test via UART
+#
+#   usage: ./send_cfgmem_image.sh <tty> <mem no> <image file>
+#
+# Each line is sent after `ACK <received byte>` of the previous line,
+# so the console buffer is not overrun while the target is programming.
+#
+
+if [ $# != 3 ]; then
+	echo "usage: $0 <tty> <mem no> <image file>"
+	exit 1
+fi
+
+TTY=$1
+MEM_NO=$2
+IMAGE=$3
+ACK_TIMEOUT=5
+
+SIZE=$(stat -c %s "$IMAGE")
+CRC=$(python3 -c "import sys,zlib; print('%08x' % zlib.crc32(open(sys.argv[1],'rb').read()))" "$IMAGE")
+
+wait_ack() {
+	while read -r -t $ACK_TIMEOUT LINE <&3
+	do
+		case "$LINE" in
+		"ACK $1" | "ACK $1"$'\r')
+			return 0
+			;;
+		*"!!!"* | *"Invalid"*)
+			echo "$LINE"
+			return 1
+			;;
+		esac
+	done
+
+	return 1
+}
+
+echo "*******************************************************"
+echo "* Send header (Config Memory $MEM_NO, $SIZE byte, CRC32 $CRC)"
+echo "*******************************************************"
+stty -F "$TTY" raw -echo
+exec 3<>"$TTY"
+echo "$MEM_NO $SIZE $CRC" >&3
+if ! wait_ack 0; then
+	echo "No ACK for the header"
+	exit 1
+fi
+
+echo "*******************************************************"
+echo "* Send image (32 byte per line)"
+echo "*******************************************************"
+SENT=0
+xxd -p -c 32 "$IMAGE" | while read -r DATA
+do
+	echo "$DATA" >&3
+	SENT=$((SENT + ${#DATA} / 2))
+	if ! wait_ack $SENT; then
+		echo "No ACK at $SENT byte"
+		exit 1
+	fi
+done || exit 1
+
+echo "Image is sent, please check the result"
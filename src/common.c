@@ -74,6 +74,11 @@ bool assert32(uint32_t addr, uint32_t exp, uint32_t retry)
 	return false;
 }
 
+uint32_t get_elapsed_us(uint32_t start_cycle)
+{
+	return k_cyc_to_us_floor32(k_cycle_get_32() - start_cycle);
+}
+
 void print_result(uint32_t test_no, uint32_t err_cnt)
 {
 	if (err_cnt == 0) {
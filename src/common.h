@@ -27,6 +27,7 @@ void write16(uint32_t addr, uint16_t val);
 uint32_t read32(uint32_t addr);
 void write32(uint32_t addr, uint32_t val);
 bool assert32(uint32_t addr, uint32_t exp, uint32_t retry);
+uint32_t get_elapsed_us(uint32_t start_cycle);
 void print_result();
 
 #endif /* SCOBCA1_FPGA_TEST_COMMON_H_ */
@@ -13,6 +13,10 @@
 #define SCOBCA1_FPGA_HRMEM_MIRROR_BASE_ADDR  (0x60000000)
 #define SCOBCA1_FPGA_HRMEM_CTRL_BASE_ADDR    (0x40500000)
 
+/* Image buffer area for QSPI memory programming */
+#define HRMEM_IMAGE_MEM_ADDR (0x00300000)
+#define HRMEM_IMAGE_MEM_SIZE (0x00D00000)
+
 /* Offset */
 #define HRMEM_ECCCOLENR_OFFSET     (0x0000) /* ECC Error Collect Enable Register */
 #define HRMEM_MEMSCRCTRLR_OFFSET   (0x0008) /* Memory Scrubing Control Register */
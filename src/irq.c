@@ -9,6 +9,7 @@
 #include "common.h"
 #include "hrmem_test.h"
 #include "qspi_common.h"
+#include "qspi_async.h"
 #include "can.h"
 #include "system_monitor_reg.h"
 
@@ -22,6 +23,7 @@
 #define SYSMON_BHM_ISR_INIT_MASK (0x00000001)
 #define SYSMON_BHM_ISR_SWA_MASK  (0x00000002)
 #define SYSMON_BHM_ISR_ERR_MASK  (0x00073F00)
+#define QSPI_ISR_CTRLDONE_MASK   (0x00000001)
 
 uint32_t irq_err_cnt = 0;
 
@@ -68,6 +70,19 @@ void can_irq_cb(void *arg)
 	}
 }
 
+void qspi_irq_cb(void *arg)
+{
+	uint32_t base = (uint32_t)arg;
+	uint32_t isr = sys_read32(SCOBCA1_FPGA_QSPI_ISR(base));
+
+	sys_write32(isr, SCOBCA1_FPGA_QSPI_ISR(base));
+
+	/* Check SPI Control Done bit */
+	if ((isr & QSPI_ISR_CTRLDONE_MASK) != 0) {
+		qspi_async_control_done(base);
+	}
+}
+
 void sysmon_hw_irq_cb(void *arg)
 {
 	uint32_t isr = sys_read32(SCOBCA1_FPGA_SYSMON_INT_STATUS);
@@ -108,6 +123,12 @@ void irq_init(void) {
 	IRQ_CONNECT(IRQ_NO_HRMEM, IRQ_PRIO, hrmem_irq_cb, NULL, 0);
 	irq_enable(IRQ_NO_HRMEM);
 
+	IRQ_CONNECT(IRQ_NO_QSPI_CFG, IRQ_PRIO, qspi_irq_cb, (void *)SCOBCA1_FPGA_CFG_BASE_ADDR, 0);
+	irq_enable(IRQ_NO_QSPI_CFG);
+
+	IRQ_CONNECT(IRQ_NO_QSPI_DATA, IRQ_PRIO, qspi_irq_cb, (void *)SCOBCA1_FPGA_DATA_BASE_ADDR, 0);
+	irq_enable(IRQ_NO_QSPI_DATA);
+
 	IRQ_CONNECT(IRQ_NO_CAN, IRQ_PRIO, can_irq_cb, NULL, 0);
 	irq_enable(IRQ_NO_CAN);
 
@@ -123,6 +144,7 @@ void irq_init(void) {
 
 	write32(SCOBCA1_FPGA_SYSMON_INT_ENABLE, SYSMON_HW_IER_ALL);
 	/* BHM IER is enabled by bhm_test.c */
+	/* QSPI IER is enabled by qspi_async.c */
 
 	/* Enable HRMEM Scrubing */
 	write32(SCOBCA1_FPGA_HRMEM_ECCCOLENR, 0x01);
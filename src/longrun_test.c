@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include "longrun_test.h"
 #include "common.h"
 #include "general_timer_reg.h"
@@ -12,11 +13,16 @@
 #include "can_test.h"
 #include "qspi_common.h"
 #include "qspi_norflash_test.h"
+#include "qspi_norflash_sched.h"
+#include "qspi_norflash_wear.h"
 #include "qspi_fram_test.h"
+#include "qspi_async.h"
 
 #define LONGRUN_STACK_SIZE (2048u)
 #define THREAD_PRIORITY (7u)
 #define FRAM_TEST_SIZE (KB(16))
+#define NORFLASH_XFER_MAX (8u)
+#define NORFLASH_XFER_TIMEOUT_MS (60000u)
 
 K_THREAD_STACK_DEFINE(_longrun_thread_stack, LONGRUN_STACK_SIZE);
 static struct k_thread _k_thread_data;
@@ -40,13 +46,15 @@ static uint32_t data_mem_addr_0 = 0x00000000;
 static uint32_t data_mem_addr_1 = 0x00100000;
 static uint32_t fram_mem_addr_0 = 0x000000;
 static int32_t fram_mem_addr_1 = 0x001000;
+static struct qspi_async_xfer norflash_xfers[NORFLASH_XFER_MAX];
+static uint8_t norflash_xfer_count = 0;
+static struct norflash_sched_job norflash_jobs[QSPI_NOR_FLASH_SCHED_JOB_MAX];
 
 extern bool is_exit;
 extern uint32_t irq_err_cnt;
 
 enum NorflashState
 {
-	NORFLASH_STATE_ERASED,
 	NORFLASH_STATE_WROTE,
 	NORFLASH_STATE_IDLE,
 };
@@ -64,24 +72,9 @@ static bool check_norflash_erase_cycle(void)
 
 	if (last_erase_time == 0) {
 		last_erase_time = current_time;
-		norflash_state = NORFLASH_STATE_ERASED;
 		return true;
 	} else if((current_time - last_erase_time) > 60) {
 		last_erase_time = current_time;
-		norflash_state = NORFLASH_STATE_ERASED;
-		return true;
-	}
-
-	return false;
-}
-
-static bool check_norflash_write_cycle(void)
-{
-	uint32_t current_time = get_obc_uptime();
-
-	if (norflash_state == NORFLASH_STATE_ERASED &&
-			(current_time - last_erase_time) > 1) {
-		norflash_state = NORFLASH_STATE_WROTE;
 		return true;
 	}
 
@@ -97,93 +90,113 @@ static bool check_norflash_read_cycle(void)
 	return false;
 }
 
-static uint32_t config_memory_erase(void)
+static struct qspi_async_xfer *get_norflash_xfer(enum QspiAsyncOp op, uint32_t base,
+												uint8_t mem_no, uint32_t mem_addr)
 {
-	uint32_t err_cnt = 0;
-	uint32_t base = SCOBCA1_FPGA_CFG_BASE_ADDR;
+	struct qspi_async_xfer *xfer;
 
-	/* Block Erase on Config Memory 0 */
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_BLOCK,
-							cfg_mem_addr_0, false)) {
-		err_cnt++;
+	if (norflash_xfer_count >= NORFLASH_XFER_MAX) {
+		err("  !!! Assertion failed: Too many NOR flash requests\n");
+		return NULL;
 	}
 
-	/* Block Erase on Config Memory 1 */
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM1, QSPI_ERASE_BLOCK,
-							cfg_mem_addr_1, false)) {
-		err_cnt++;
-	}
+	xfer = &norflash_xfers[norflash_xfer_count];
+	memset(xfer, 0, sizeof(*xfer));
+	xfer->op = op;
+	xfer->base = base;
+	xfer->mem_no = mem_no;
+	xfer->mem_addr = mem_addr;
 
-	erase_count++;
-	return err_cnt;
+	return xfer;
 }
 
-static uint32_t data_memory_erase(void)
+static bool submit_norflash_xfer(struct qspi_async_xfer *xfer)
 {
-	uint32_t err_cnt = 0;
-	uint32_t base = SCOBCA1_FPGA_DATA_BASE_ADDR;
-
-	/* Block Erase on Config Memory 0 */
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_BLOCK,
-							data_mem_addr_0, false)) {
-		err_cnt++;
+	if (xfer == NULL || !qspi_async_submit(xfer)) {
+		return false;
 	}
+	norflash_xfer_count++;
 
-	/* Block Erase on Config Memory 1 */
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM1, QSPI_ERASE_BLOCK,
-							data_mem_addr_1, false)) {
-		err_cnt++;
+	return true;
+}
+
+static bool submit_norflash_rw(enum QspiAsyncOp op, uint32_t base, uint8_t mem_no,
+								uint32_t mem_addr, uint8_t start_val)
+{
+	struct qspi_async_xfer *xfer;
+
+	xfer = get_norflash_xfer(op, base, mem_no, mem_addr);
+	if (xfer != NULL) {
+		xfer->size = QSPI_NOR_FLASH_BLOCK_BYTE;
+		xfer->start_val = start_val;
+		xfer->is_init = false;
 	}
 
-	return err_cnt;
+	return submit_norflash_xfer(xfer);
 }
 
-static uint32_t config_memory_write(void)
+static uint32_t wait_norflash_xfers(void)
 {
 	uint32_t err_cnt = 0;
-	uint32_t base = SCOBCA1_FPGA_CFG_BASE_ADDR;
-
-	/* Block Write to Config Memory 0 */
-	if (!qspi_norflash_multi_write(base, QSPI_DATA_MEM0, cfg_mem_addr_0,
-									QSPI_NOR_FLASH_BLOCK_BYTE, cfg_write_val_0)) {
-		err_cnt++;
-	}
-	cfg_read_val_0 = cfg_write_val_0;
-	cfg_write_val_0++;
 
-	/* Block Write to Config Memory 1 */
-	if (!qspi_norflash_multi_write(base, QSPI_DATA_MEM1, cfg_mem_addr_1,
-									QSPI_NOR_FLASH_BLOCK_BYTE, cfg_write_val_1)) {
-		err_cnt++;
+	for (uint8_t i=0; i<norflash_xfer_count; i++) {
+		if (!qspi_async_wait(&norflash_xfers[i], K_MSEC(NORFLASH_XFER_TIMEOUT_MS))) {
+			err("  !!! NOR flash request %d (0x%08x [%d]) failed\n",
+					norflash_xfers[i].op, norflash_xfers[i].base, norflash_xfers[i].mem_no);
+			err_cnt++;
+		}
 	}
-	cfg_read_val_1 = cfg_write_val_1;
-	cfg_write_val_1++;
+	norflash_xfer_count = 0;
 
 	return err_cnt;
 }
 
-static uint32_t data_memory_write(void)
+static void set_norflash_job(struct norflash_sched_job *job, uint32_t base, uint8_t mem_no,
+								uint32_t mem_addr, uint8_t start_val)
 {
-	uint32_t err_cnt = 0;
-	uint32_t base = SCOBCA1_FPGA_DATA_BASE_ADDR;
+	memset(job, 0, sizeof(*job));
+	job->base = base;
+	job->mem_no = mem_no;
+	job->mem_addr = mem_addr;
+	job->size = QSPI_NOR_FLASH_BLOCK_BYTE;
+	job->start_val = start_val;
+}
 
-	/* Block Write to Data Memory 0 */
-	if (!qspi_norflash_multi_write(base, QSPI_DATA_MEM0, data_mem_addr_0,
-									QSPI_NOR_FLASH_BLOCK_BYTE, data_write_val_0)) {
-		err_cnt++;
+/*
+ * Block Erase and Block Write on Config Memory 0/1 and Data Memory 0/1.
+ * All memories are erased at once, and each memory is programmed as soon
+ * as its erase is completed.
+ */
+static uint32_t norflash_erase_write(void)
+{
+	struct qspi_async_xfer *xfer;
+
+	set_norflash_job(&norflash_jobs[0], SCOBCA1_FPGA_CFG_BASE_ADDR, QSPI_CFG_MEM0,
+						cfg_mem_addr_0, cfg_write_val_0);
+	set_norflash_job(&norflash_jobs[1], SCOBCA1_FPGA_CFG_BASE_ADDR, QSPI_CFG_MEM1,
+						cfg_mem_addr_1, cfg_write_val_1);
+	set_norflash_job(&norflash_jobs[2], SCOBCA1_FPGA_DATA_BASE_ADDR, QSPI_DATA_MEM0,
+						data_mem_addr_0, data_write_val_0);
+	set_norflash_job(&norflash_jobs[3], SCOBCA1_FPGA_DATA_BASE_ADDR, QSPI_DATA_MEM1,
+						data_mem_addr_1, data_write_val_1);
+
+	cfg_read_val_0 = cfg_write_val_0++;
+	cfg_read_val_1 = cfg_write_val_1++;
+	data_read_val_0 = data_write_val_0++;
+	data_read_val_1 = data_write_val_1++;
+	erase_count++;
+
+	xfer = get_norflash_xfer(QSPI_ASYNC_SCHED, 0, 0, 0);
+	if (xfer != NULL) {
+		xfer->jobs = norflash_jobs;
+		xfer->job_num = ARRAY_SIZE(norflash_jobs);
 	}
-	data_read_val_0 = data_write_val_0;
-	data_write_val_0++;
 
-	/* Block Write to Data Memory 1 */
-	if (!qspi_norflash_multi_write(base, QSPI_DATA_MEM1, data_mem_addr_1,
-									QSPI_NOR_FLASH_BLOCK_BYTE, data_write_val_1)) {
-		err_cnt++;
+	if (!submit_norflash_xfer(xfer)) {
+		return 1;
 	}
-	data_read_val_1 = data_write_val_1;
-	data_write_val_1++;
 
-	return err_cnt;
+	return 0;
 }
 
 static uint32_t config_memory_read(void)
@@ -192,14 +205,14 @@ static uint32_t config_memory_read(void)
 	uint32_t base = SCOBCA1_FPGA_CFG_BASE_ADDR;
 
 	/* Read Block data (64KB) from Config Memory 0 */
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM0, cfg_mem_addr_0,
-								QSPI_NOR_FLASH_BLOCK_BYTE, cfg_read_val_0, false)) {
+	if (!submit_norflash_rw(QSPI_ASYNC_READ, base, QSPI_DATA_MEM0, cfg_mem_addr_0,
+							cfg_read_val_0)) {
 		err_cnt++;
 	}
 
 	/* Read Block data (64KB) from Config Memory 1 */
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM1, cfg_mem_addr_1,
-								QSPI_NOR_FLASH_BLOCK_BYTE, cfg_read_val_1, false)) {
+	if (!submit_norflash_rw(QSPI_ASYNC_READ, base, QSPI_DATA_MEM1, cfg_mem_addr_1,
+							cfg_read_val_1)) {
 		err_cnt++;
 	}
 
@@ -212,14 +225,14 @@ static uint32_t data_memory_read(void)
 	uint32_t base = SCOBCA1_FPGA_DATA_BASE_ADDR;
 
 	/* Read Block data (64KB) from Data Memory 0 */
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM0, data_mem_addr_0,
-								QSPI_NOR_FLASH_BLOCK_BYTE, data_read_val_0, false)) {
+	if (!submit_norflash_rw(QSPI_ASYNC_READ, base, QSPI_DATA_MEM0, data_mem_addr_0,
+							data_read_val_0)) {
 		err_cnt++;
 	}
 
 	/* Read Block data (64KB) from Data Memory 1 */
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM1, data_mem_addr_1,
-								QSPI_NOR_FLASH_BLOCK_BYTE, data_read_val_1, false)) {
+	if (!submit_norflash_rw(QSPI_ASYNC_READ, base, QSPI_DATA_MEM1, data_mem_addr_1,
+							data_read_val_1)) {
 		err_cnt++;
 	}
 
@@ -269,6 +282,7 @@ static void start_longrun_test(void *p1, void *p2, void *p3)
 	bool ret;
 	uint32_t err_cnt = 0;
 	uint16_t loop_count = 0;
+	bool is_erase_cycle;
 	uint32_t hrmem_start_val = 0x00;
 	uint32_t hrmem_next_val;
 
@@ -293,15 +307,27 @@ static void start_longrun_test(void *p1, void *p2, void *p3)
 	while (true) {
 		loop_count++;
 
-		if (check_norflash_erase_cycle()) {
-			/* Block Erase NOR flash */
-			info("* [#] Erase Config Memory\n");
-			err_cnt += config_memory_erase();
-			info("* [#] Erase Data Memory\n");
-			err_cnt += data_memory_erase();
-			norflash_state = NORFLASH_STATE_ERASED;
+		is_erase_cycle = check_norflash_erase_cycle();
+		if (is_erase_cycle) {
+			/* Block Erase and Write NOR flash */
+			info("* [#] Start Erase/Write Config/Data Memory Test\n");
+			err_cnt += norflash_erase_write();
+			norflash_state = NORFLASH_STATE_WROTE;
+		} else if (check_norflash_read_cycle()) {
+			/* Read Config Memory Test */
+			info("* [#] Start Read Config Memory Test\n");
+			err_cnt += config_memory_read();
+
+			/* Read Data Memory Test */
+			info("* [#] Start Read Data Memory Test\n");
+			err_cnt += data_memory_read();
 		}
 
+		/*
+		 * NOR flash requests run on the QSPI async thread while
+		 * the following tests are running
+		 */
+
 		/* Dump Board Halth Monitoring */
 		info("* [#] Dump Board Halth Monitoring\n");
 		err_cnt += bhm_read_sensor_data();
@@ -320,29 +346,20 @@ static void start_longrun_test(void *p1, void *p2, void *p3)
 		info("* [#] Start CAN Loop back Test\n");
 		err_cnt += can_loopback();
 
-		if (check_norflash_write_cycle()) {
-			/* Write Config Memory Test */
-			info("* [#] Start Write Config Memory Test\n");
-			err_cnt += config_memory_write();
-
-			/* Write Data Memory Test */
-			info("* [#] Start Write Data Memory Test\n");
-			err_cnt += data_memory_write();
-		}
-
-		if (check_norflash_read_cycle()) {
-			/* Read Config Memory Test */
-			info("* [#] Start Read Config Memory Test\n");
-			err_cnt += config_memory_read();
-
-			/* Read Data Memory Test */
-			info("* [#] Start Read Data Memory Test\n");
-			err_cnt += data_memory_read();
-		}
+		/* Wait for Config/Data Memory requests */
+		info("* [#] Wait Config/Data Memory Test\n");
+		err_cnt += wait_norflash_xfers();
 
 		info("* Loop [%d][uptime:%d][erase:%d] Total assertion: %d, IRQ assertion: %d\n",
 					loop_count, get_obc_uptime(), erase_count, err_cnt, irq_err_cnt);
 
+		/* Erase/Program busy time trend, stored on every Erase cycle */
+		qspi_norflash_wear_print_trend();
+		if (is_erase_cycle && !qspi_norflash_wear_store()) {
+			err("  !!! Can not store NOR flash wear record\n");
+			err_cnt++;
+		}
+
 		if (is_exit) {
 			printk("* Stop Long Run Test\n");
 			is_exit = false;
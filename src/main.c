@@ -16,6 +16,18 @@
 #include "qspi_common.h"
 #include "qspi_norflash_test.h"
 #include "qspi_fram_test.h"
+#include "qspi_fram_mirror.h"
+#include "qspi_fram_march.h"
+#include "qspi_async.h"
+#include "qspi_norflash_sched.h"
+#include "qspi_norflash_stripe.h"
+#include "qspi_norflash_mirror.h"
+#include "qspi_cfgmem_program.h"
+#include "qspi_norflash_delta.h"
+#include "qspi_norflash_wear.h"
+#include "qspi_norflash_driver.h"
+#include "qspi_calib.h"
+#include "qspi_bench.h"
 #include "usb_crack_test.h"
 #include "pudc_crack_test.h"
 #include "sys_clock_crack_test.h"
@@ -65,6 +77,19 @@ enum ScTestNo {
 	SC_TEST_CRACK_I2C_INTERNAL,
 	SC_TEST_TRCH_CFG_MEM_MONI,
 	SC_TEST_HARDWARE_OPTIONS,
+	SC_TEST_QSPI_NORFLASH_SCHED,
+	SC_TEST_QSPI_DATA_MEM_STRIPE,
+	SC_TEST_QSPI_CFG_MEM_MIRROR,
+	SC_TEST_QSPI_CFG_MEM_PROGRAM,
+	SC_TEST_QSPI_DATA_MEM_DELTA,
+	SC_TEST_QSPI_DATA_MEM_DRIVER,
+	SC_TEST_QSPI_CALIBRATION,
+	SC_TEST_QSPI_BENCHMARK,
+	SC_TEST_QSPI_NOR_FLASH_WEAR,
+	SC_TEST_QSPI_NOR_FLASH_BLANK_CHECK,
+	SC_TEST_QSPI_DATA_MEM_ERASE_SUSPEND,
+	SC_TEST_QSPI_FRAM_MIRROR,
+	SC_TEST_QSPI_FRAM_MARCH,
 };
 
 bool is_exit;
@@ -104,6 +129,21 @@ void print_menu(void)
 	info("[%d] Internal I2C crack Test\n", SC_TEST_CRACK_I2C_INTERNAL);
 	info("[%d] Config Memory TRCH_CFG_MEM_MONI Test\n", SC_TEST_TRCH_CFG_MEM_MONI);
 	info("[%d] Hardware Option Pin Test\n", SC_TEST_HARDWARE_OPTIONS);
+	info("[%d] QSPI Config/Data Memory Concurrent Test (Block)\n", SC_TEST_QSPI_NORFLASH_SCHED);
+	info("[%d] QSPI Data Memory Striped Test\n", SC_TEST_QSPI_DATA_MEM_STRIPE);
+	info("[%d] QSPI Config Memory Mirrored Test\n", SC_TEST_QSPI_CFG_MEM_MIRROR);
+	info("[%d] QSPI Config Memory Programming (via UART)\n", SC_TEST_QSPI_CFG_MEM_PROGRAM);
+	info("[%d] QSPI Data Memory Delta Update Test\n", SC_TEST_QSPI_DATA_MEM_DELTA);
+#if defined(CONFIG_SCOBC_QSPI_NOR_FLASH)
+	info("[%d] QSPI Data Memory Flash Driver Test\n", SC_TEST_QSPI_DATA_MEM_DRIVER);
+#endif
+	info("[%d] QSPI Clock Calibration\n", SC_TEST_QSPI_CALIBRATION);
+	info("[%d] QSPI Benchmark\n", SC_TEST_QSPI_BENCHMARK);
+	info("[%d] QSPI NOR Flash Wear Trend\n", SC_TEST_QSPI_NOR_FLASH_WEAR);
+	info("[%d] QSPI NOR Flash Blank Check (whole memory)\n", SC_TEST_QSPI_NOR_FLASH_BLANK_CHECK);
+	info("[%d] QSPI Data Memory Erase Suspend Test\n", SC_TEST_QSPI_DATA_MEM_ERASE_SUSPEND);
+	info("[%d] QSPI FRAM Mirrored Write Test\n", SC_TEST_QSPI_FRAM_MIRROR);
+	info("[%d] QSPI FRAM March Test (whole memory)\n", SC_TEST_QSPI_FRAM_MARCH);
 }
 
 static void print_ids(void)
@@ -129,6 +169,7 @@ void main(void)
 
 	start_kick_wdt_thread();
 	irq_init();
+	start_qspi_async_thread();
 	console_getline_init();
 
 	info("This is the FPGA test program for SC-OBC-A1\n");
@@ -251,6 +292,47 @@ void main(void)
 		case SC_TEST_HARDWARE_OPTIONS:
 			hardware_options_test();
 			break;
+		case SC_TEST_QSPI_NORFLASH_SCHED:
+			qspi_norflash_sched_test(test_no);
+			break;
+		case SC_TEST_QSPI_DATA_MEM_STRIPE:
+			qspi_data_memory_stripe_test(test_no);
+			break;
+		case SC_TEST_QSPI_CFG_MEM_MIRROR:
+			qspi_config_memory_mirror_test(test_no);
+			break;
+		case SC_TEST_QSPI_CFG_MEM_PROGRAM:
+			qspi_config_memory_program_test(test_no);
+			break;
+		case SC_TEST_QSPI_DATA_MEM_DELTA:
+			qspi_norflash_delta_update_test(test_no);
+			break;
+#if defined(CONFIG_SCOBC_QSPI_NOR_FLASH)
+		case SC_TEST_QSPI_DATA_MEM_DRIVER:
+			qspi_norflash_driver_test(test_no);
+			break;
+#endif
+		case SC_TEST_QSPI_CALIBRATION:
+			qspi_calib_test(test_no);
+			break;
+		case SC_TEST_QSPI_BENCHMARK:
+			qspi_bench_test(test_no);
+			break;
+		case SC_TEST_QSPI_NOR_FLASH_WEAR:
+			qspi_norflash_wear_test(test_no);
+			break;
+		case SC_TEST_QSPI_NOR_FLASH_BLANK_CHECK:
+			qspi_norflash_blank_check_test(test_no);
+			break;
+		case SC_TEST_QSPI_DATA_MEM_ERASE_SUSPEND:
+			qspi_data_memory_erase_suspend_test(test_no);
+			break;
+		case SC_TEST_QSPI_FRAM_MIRROR:
+			qspi_fram_mirror_test(test_no);
+			break;
+		case SC_TEST_QSPI_FRAM_MARCH:
+			qspi_fram_march_test(test_no);
+			break;
 		default:
 			break;
 		}
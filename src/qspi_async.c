@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "qspi_async.h"
+#include "qspi_norflash_test.h"
+#include "common.h"
+
+#define QSPI_ASYNC_STACK_SIZE (2048u)
+#define QSPI_ASYNC_THREAD_PRIORITY (6u)
+#define QSPI_ASYNC_QUEUE_LEN (8u)
+#define QSPI_IER_CONTROL_DONE (0x00000001)
+#define QSPI_CONTROL_DONE_TIMEOUT_MS (10u)
+
+K_THREAD_STACK_DEFINE(_qspi_async_thread_stack, QSPI_ASYNC_STACK_SIZE);
+static struct k_thread _k_thread_data;
+K_MSGQ_DEFINE(qspi_async_msgq, sizeof(struct qspi_async_xfer *), QSPI_ASYNC_QUEUE_LEN, 4);
+
+/* SPI Control Done is signaled from QSPI IRQ (Config Memory / Data Memory) */
+K_SEM_DEFINE(qspi_cfg_done_sem, 0, 1);
+K_SEM_DEFINE(qspi_data_done_sem, 0, 1);
+static bool is_irq_mode = false;
+
+static struct k_sem *get_control_done_sem(uint32_t base)
+{
+	if (base == SCOBCA1_FPGA_CFG_BASE_ADDR) {
+		return &qspi_cfg_done_sem;
+	} else if (base == SCOBCA1_FPGA_DATA_BASE_ADDR) {
+		return &qspi_data_done_sem;
+	}
+
+	return NULL;
+}
+
+bool qspi_async_is_irq_mode(uint32_t base)
+{
+	return is_irq_mode && get_control_done_sem(base) != NULL;
+}
+
+void qspi_async_clear_control_done(uint32_t base)
+{
+	struct k_sem *sem = get_control_done_sem(base);
+
+	if (sem != NULL) {
+		k_sem_reset(sem);
+	}
+}
+
+bool qspi_async_wait_control_done(uint32_t base)
+{
+	struct k_sem *sem = get_control_done_sem(base);
+
+	if (sem == NULL) {
+		return false;
+	}
+
+	if (k_sem_take(sem, K_MSEC(QSPI_CONTROL_DONE_TIMEOUT_MS)) != 0) {
+		err("  !!! Assertion failed: QSPI (0x%08x) SPI Control Done timed out\n", base);
+		return false;
+	}
+
+	return true;
+}
+
+/* Called from QSPI IRQ */
+void qspi_async_control_done(uint32_t base)
+{
+	struct k_sem *sem = get_control_done_sem(base);
+
+	if (sem != NULL) {
+		k_sem_give(sem);
+	}
+}
+
+static bool qspi_async_run(struct qspi_async_xfer *xfer)
+{
+	switch (xfer->op) {
+	case QSPI_ASYNC_ERASE:
+		return qspi_norflash_erase(xfer->base, xfer->mem_no, xfer->type,
+								xfer->mem_addr, xfer->is_wait_idle, &xfer->erase_time_us);
+	case QSPI_ASYNC_WRITE:
+		return qspi_norflash_multi_write(xfer->base, xfer->mem_no, xfer->mem_addr,
+										xfer->size, xfer->start_val);
+	case QSPI_ASYNC_READ:
+		return qspi_norflash_bulk_read(xfer->base, xfer->mem_no, xfer->mem_addr,
+										xfer->size, xfer->start_val, xfer->is_init);
+	case QSPI_ASYNC_SCHED:
+		return qspi_norflash_sched_run(xfer->jobs, xfer->job_num);
+	default:
+		err("   Invalid QSPI async operation %d\n", xfer->op);
+		return false;
+	}
+}
+
+static void qspi_async_thread(void *p1, void *p2, void *p3)
+{
+	struct qspi_async_xfer *xfer;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_msgq_get(&qspi_async_msgq, &xfer, K_FOREVER);
+
+		debug("* Start QSPI async operation %d (0x%08x)\n", xfer->op, xfer->base);
+		xfer->result = qspi_async_run(xfer);
+		if (xfer->cb != NULL) {
+			xfer->cb(xfer);
+		}
+		k_sem_give(&xfer->done);
+	}
+}
+
+bool qspi_async_submit(struct qspi_async_xfer *xfer)
+{
+	xfer->result = false;
+	xfer->erase_time_us = 0;
+	k_sem_init(&xfer->done, 0, 1);
+
+	if (k_msgq_put(&qspi_async_msgq, &xfer, K_NO_WAIT) != 0) {
+		err("  !!! Assertion failed: QSPI async queue is full\n");
+		return false;
+	}
+
+	return true;
+}
+
+bool qspi_async_wait(struct qspi_async_xfer *xfer, k_timeout_t timeout)
+{
+	if (k_sem_take(&xfer->done, timeout) != 0) {
+		err("  !!! Assertion failed: QSPI async operation %d timed out\n", xfer->op);
+		return false;
+	}
+
+	return xfer->result;
+}
+
+void start_qspi_async_thread(void)
+{
+	k_tid_t tid;
+
+	/* Enable SPI Control Done interrupt (Config Memory / Data Memory) */
+	write32(SCOBCA1_FPGA_QSPI_ISR(SCOBCA1_FPGA_CFG_BASE_ADDR), 0xFFFFFFFF);
+	write32(SCOBCA1_FPGA_QSPI_ISR(SCOBCA1_FPGA_DATA_BASE_ADDR), 0xFFFFFFFF);
+	write32(SCOBCA1_FPGA_QSPI_IER(SCOBCA1_FPGA_CFG_BASE_ADDR), QSPI_IER_CONTROL_DONE);
+	write32(SCOBCA1_FPGA_QSPI_IER(SCOBCA1_FPGA_DATA_BASE_ADDR), QSPI_IER_CONTROL_DONE);
+	is_irq_mode = true;
+
+	tid = k_thread_create(&_k_thread_data, _qspi_async_thread_stack, QSPI_ASYNC_STACK_SIZE,
+					qspi_async_thread, NULL, NULL, NULL,
+					QSPI_ASYNC_THREAD_PRIORITY, 0, K_NO_WAIT);
+	printk("Start QSPI async thread (ID: %x)\n", (unsigned int)tid);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_ASYNC_H_
+#define SCOBCA1_FPGA_TEST_QSPI_ASYNC_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+#include "qspi_norflash_sched.h"
+
+enum QspiAsyncOp
+{
+	QSPI_ASYNC_ERASE,
+	QSPI_ASYNC_WRITE,
+	QSPI_ASYNC_READ,
+	QSPI_ASYNC_SCHED,
+};
+
+struct qspi_async_xfer;
+
+typedef void (*qspi_async_cb_t)(struct qspi_async_xfer *xfer);
+
+/*
+ * NOR flash transfer request handled by the QSPI async thread.
+ * The request must stay valid until it is completed.
+ */
+struct qspi_async_xfer {
+	enum QspiAsyncOp op;
+	uint32_t base;
+	uint8_t mem_no;
+	uint32_t mem_addr;
+	enum QspiEraseType type;  /* QSPI_ASYNC_ERASE */
+	bool is_wait_idle;        /* QSPI_ASYNC_ERASE */
+	uint32_t size;            /* QSPI_ASYNC_WRITE/READ */
+	uint8_t start_val;        /* QSPI_ASYNC_WRITE/READ */
+	bool is_init;             /* QSPI_ASYNC_READ */
+	struct norflash_sched_job *jobs; /* QSPI_ASYNC_SCHED */
+	uint8_t job_num;                 /* QSPI_ASYNC_SCHED */
+	qspi_async_cb_t cb;       /* Called on the QSPI async thread (optional) */
+	void *user_data;
+	bool result;
+	uint32_t erase_time_us;   /* QSPI_ASYNC_ERASE with is_wait_idle */
+	struct k_sem done;
+};
+
+void start_qspi_async_thread(void);
+bool qspi_async_submit(struct qspi_async_xfer *xfer);
+bool qspi_async_wait(struct qspi_async_xfer *xfer, k_timeout_t timeout);
+bool qspi_async_is_irq_mode(uint32_t base);
+void qspi_async_clear_control_done(uint32_t base);
+bool qspi_async_wait_control_done(uint32_t base);
+void qspi_async_control_done(uint32_t base);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_ASYNC_H_ */
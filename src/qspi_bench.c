@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "qspi_bench.h"
+#include "qspi_ctrl.h"
+#include "qspi_norflash_test.h"
+#include "qspi_fram_test.h"
+#include "common.h"
+
+/* Benchmark area on each NOR flash (Sector/Half Block/Block Erase) */
+#define QSPI_BENCH_NOR_SECTOR_ADDR     (0x00F00000)
+#define QSPI_BENCH_NOR_HALF_BLOCK_ADDR (0x00F10000)
+#define QSPI_BENCH_NOR_BLOCK_ADDR      (0x00F20000)
+#define QSPI_BENCH_FRAM_ADDR           (0x00060000)
+
+#define QSPI_BENCH_SECTOR_ERASE_COUNT     (8u)
+#define QSPI_BENCH_HALF_BLOCK_ERASE_COUNT (2u)
+#define QSPI_BENCH_BLOCK_ERASE_COUNT      (2u)
+#define QSPI_BENCH_PROGRAM_COUNT          (64u)
+#define QSPI_BENCH_CHUNK_READ_COUNT       (QSPI_BENCH_SAMPLE_MAX)
+#define QSPI_BENCH_BULK_READ_COUNT        (8u)
+#define QSPI_BENCH_FRAM_WRITE_COUNT       (QSPI_BENCH_SAMPLE_MAX)
+#define QSPI_BENCH_FRAM_BULK_WRITE_COUNT  (8u)
+
+#define QSPI_BENCH_CHUNK_BYTE      (QSPI_FIFO_DEPTH)
+#define QSPI_BENCH_BULK_READ_BYTE  (QSPI_NOR_FLASH_BLOCK_BYTE)
+#define QSPI_BENCH_FRAM_BULK_BYTE  (QSPI_NOR_FLASH_SECTOR_BYTE)
+
+struct qspi_bench_dev {
+	const char *name;
+	enum QspiCtrlId ctrl;
+	uint8_t mem_no;
+};
+
+typedef bool (*qspi_bench_op_t)(const struct qspi_bench_dev *dev, uint32_t i);
+
+static const struct qspi_bench_dev norflash_bench_dev[] = {
+	{"CFG0", QSPI_CTRL_CFG, QSPI_CFG_MEM0},
+	{"CFG1", QSPI_CTRL_CFG, QSPI_CFG_MEM1},
+	{"DATA0", QSPI_CTRL_DATA, QSPI_DATA_MEM0},
+	{"DATA1", QSPI_CTRL_DATA, QSPI_DATA_MEM1},
+};
+
+static const struct qspi_bench_dev fram_bench_dev[] = {
+	{"FRAM0", QSPI_CTRL_FRAM, QSPI_FRAM_MEM0},
+	{"FRAM1", QSPI_CTRL_FRAM, QSPI_FRAM_MEM1},
+};
+
+static uint32_t get_bench_base(const struct qspi_bench_dev *dev)
+{
+	return qspi_ctrl_get_by_id(dev->ctrl)->base;
+}
+
+static struct qspi_bench_stat bench_stat;
+static uint8_t bench_data[QSPI_NOR_FLASH_PAGE_BYTE];
+static uint8_t bench_bulk_data[QSPI_BENCH_FRAM_BULK_BYTE];
+
+void qspi_bench_stat_add(struct qspi_bench_stat *stat, uint32_t elapsed_us)
+{
+	if (stat->count < QSPI_BENCH_SAMPLE_MAX) {
+		stat->sample_us[stat->count++] = elapsed_us;
+	}
+}
+
+static void sort_samples(uint32_t *sample, uint32_t count)
+{
+	uint32_t val;
+	int32_t j;
+
+	for (uint32_t i=1; i<count; i++) {
+		val = sample[i];
+		for (j=i-1; j>=0 && sample[j]>val; j--) {
+			sample[j+1] = sample[j];
+		}
+		sample[j+1] = val;
+	}
+}
+
+void qspi_bench_print_header(void)
+{
+	info("BENCH,dev,op,size,count,min_us,avg_us,max_us,p99_us,MBps\n");
+}
+
+/* Print one CSV line. The samples are sorted in place. */
+void qspi_bench_print(const char *dev, const char *op, uint32_t size,
+						struct qspi_bench_stat *stat)
+{
+	uint64_t total_us = 0;
+	uint32_t avg_us;
+	uint32_t p99;
+
+	if (stat->count == 0) {
+		info("BENCH,%s,%s,%d,0,,,,,\n", dev, op, size);
+		return;
+	}
+
+	sort_samples(stat->sample_us, stat->count);
+	for (uint32_t i=0; i<stat->count; i++) {
+		total_us += stat->sample_us[i];
+	}
+	avg_us = total_us / stat->count;
+	p99 = (stat->count * 99 + 99) / 100 - 1;
+
+	info("BENCH,%s,%s,%d,%d,%d,%d,%d,%d,%.3f\n", dev, op, size, stat->count,
+			stat->sample_us[0], avg_us, stat->sample_us[stat->count - 1],
+			stat->sample_us[p99], (double)size / MAX(avg_us, 1));
+}
+
+static bool run_bench(const struct qspi_bench_dev *dev, const char *op_name,
+						qspi_bench_op_t op, uint32_t size, uint32_t count)
+{
+	uint32_t start_cycle;
+
+	bench_stat.count = 0;
+	for (uint32_t i=0; i<count; i++) {
+		start_cycle = k_cycle_get_32();
+		if (!op(dev, i)) {
+			err("  !!! %s %s failed (%d)\n", dev->name, op_name, i);
+			return false;
+		}
+		qspi_bench_stat_add(&bench_stat, get_elapsed_us(start_cycle));
+	}
+	qspi_bench_print(dev->name, op_name, size, &bench_stat);
+
+	return true;
+}
+
+static bool discard_read_data(const uint8_t *data, size_t size, void *arg)
+{
+	ARG_UNUSED(data);
+	ARG_UNUSED(size);
+	ARG_UNUSED(arg);
+
+	return true;
+}
+
+static bool norflash_sector_erase(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	return qspi_norflash_erase(get_bench_base(dev), dev->mem_no, QSPI_ERASE_SECTOR,
+								QSPI_BENCH_NOR_SECTOR_ADDR + i * QSPI_NOR_FLASH_SECTOR_BYTE,
+								true, NULL);
+}
+
+static bool norflash_half_block_erase(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	return qspi_norflash_erase(get_bench_base(dev), dev->mem_no, QSPI_ERASE_HALF_BLOCK,
+								QSPI_BENCH_NOR_HALF_BLOCK_ADDR + i * QSPI_NOR_FLASH_BLOCK_BYTE / 2,
+								true, NULL);
+}
+
+static bool norflash_block_erase(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	return qspi_norflash_erase(get_bench_base(dev), dev->mem_no, QSPI_ERASE_BLOCK,
+								QSPI_BENCH_NOR_BLOCK_ADDR + i * QSPI_NOR_FLASH_BLOCK_BYTE,
+								true, NULL);
+}
+
+/* Programmed on the erased Block */
+static bool norflash_page_program(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	if (!qspi_norflash_page_program_start(get_bench_base(dev), dev->mem_no,
+											QSPI_BENCH_NOR_BLOCK_ADDR + i * QSPI_NOR_FLASH_PAGE_BYTE,
+											bench_data, QSPI_NOR_FLASH_PAGE_BYTE)) {
+		return false;
+	}
+
+	return qspi_norflash_wait_ready(get_bench_base(dev), dev->mem_no, NORFLASH_BUSY_PROGRAM,
+									k_cycle_get_32());
+}
+
+/* Area written by the benchmark on each memory */
+static uint32_t get_bench_read_addr(const struct qspi_bench_dev *dev)
+{
+	if (dev->ctrl == QSPI_CTRL_FRAM) {
+		return QSPI_BENCH_FRAM_ADDR;
+	}
+
+	return QSPI_BENCH_NOR_BLOCK_ADDR;
+}
+
+/* NOR flash and FRAM are read by the op table of the controller */
+static bool chunk_read(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	const struct qspi_mem_ops *ops = qspi_ctrl_get_by_id(dev->ctrl)->ops;
+
+	return ops->read(get_bench_base(dev), dev->mem_no, get_bench_read_addr(dev) + i * QSPI_BENCH_CHUNK_BYTE,
+						bench_data, QSPI_BENCH_CHUNK_BYTE);
+}
+
+static bool bulk_read(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	const struct qspi_mem_ops *ops = qspi_ctrl_get_by_id(dev->ctrl)->ops;
+
+	ARG_UNUSED(i);
+
+	return ops->read_stream(get_bench_base(dev), dev->mem_no, get_bench_read_addr(dev),
+							QSPI_BENCH_BULK_READ_BYTE, discard_read_data, NULL);
+}
+
+static bool fram_chunk_write(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	return qspi_fram_write(dev->mem_no, QSPI_BENCH_FRAM_ADDR + i * QSPI_BENCH_CHUNK_BYTE,
+							bench_data, QSPI_BENCH_CHUNK_BYTE);
+}
+
+static bool fram_bulk_write(const struct qspi_bench_dev *dev, uint32_t i)
+{
+	ARG_UNUSED(i);
+
+	return qspi_fram_write(dev->mem_no, QSPI_BENCH_FRAM_ADDR, bench_bulk_data,
+							QSPI_BENCH_FRAM_BULK_BYTE);
+}
+
+static uint32_t norflash_bench(const struct qspi_bench_dev *dev)
+{
+	uint32_t err_cnt = 0;
+
+	if (!run_bench(dev, "sector_erase", norflash_sector_erase, QSPI_NOR_FLASH_SECTOR_BYTE,
+					QSPI_BENCH_SECTOR_ERASE_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "half_block_erase", norflash_half_block_erase,
+					QSPI_NOR_FLASH_BLOCK_BYTE / 2, QSPI_BENCH_HALF_BLOCK_ERASE_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "block_erase", norflash_block_erase, QSPI_NOR_FLASH_BLOCK_BYTE,
+					QSPI_BENCH_BLOCK_ERASE_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "page_program", norflash_page_program, QSPI_NOR_FLASH_PAGE_BYTE,
+					QSPI_BENCH_PROGRAM_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "chunk_read", chunk_read, QSPI_BENCH_CHUNK_BYTE,
+					QSPI_BENCH_CHUNK_READ_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "bulk_read", bulk_read, QSPI_BENCH_BULK_READ_BYTE,
+					QSPI_BENCH_BULK_READ_COUNT)) {
+		err_cnt++;
+	}
+
+	return err_cnt;
+}
+
+static uint32_t fram_bench(const struct qspi_bench_dev *dev)
+{
+	uint32_t err_cnt = 0;
+
+	if (!run_bench(dev, "chunk_write", fram_chunk_write, QSPI_BENCH_CHUNK_BYTE,
+					QSPI_BENCH_FRAM_WRITE_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "bulk_write", fram_bulk_write, QSPI_BENCH_FRAM_BULK_BYTE,
+					QSPI_BENCH_FRAM_BULK_WRITE_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "chunk_read", chunk_read, QSPI_BENCH_CHUNK_BYTE,
+					QSPI_BENCH_CHUNK_READ_COUNT)) {
+		err_cnt++;
+	}
+	if (!run_bench(dev, "bulk_read", bulk_read, QSPI_BENCH_BULK_READ_BYTE,
+					QSPI_BENCH_BULK_READ_COUNT)) {
+		err_cnt++;
+	}
+
+	return err_cnt;
+}
+
+/*
+ * Measure the latency of each operation on Config Memory 0/1, Data
+ * Memory 0/1 and FRAM 0/1, and print the result as CSV lines starting
+ * with `BENCH,`. The benchmark areas are overwritten.
+ */
+uint32_t qspi_bench_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+
+	info("* [%d] Start QSPI Benchmark\n", test_no);
+
+	qspi_create_fifo_data(0x00, bench_data, sizeof(bench_data), false);
+	qspi_create_fifo_data(0x00, bench_bulk_data, sizeof(bench_bulk_data), false);
+
+	qspi_bench_print_header();
+	for (uint8_t i=0; i<ARRAY_SIZE(norflash_bench_dev); i++) {
+		err_cnt += norflash_bench(&norflash_bench_dev[i]);
+	}
+	for (uint8_t i=0; i<ARRAY_SIZE(fram_bench_dev); i++) {
+		err_cnt += fram_bench(&fram_bench_dev[i]);
+	}
+
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_BENCH_H_
+#define SCOBCA1_FPGA_TEST_QSPI_BENCH_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+#define QSPI_BENCH_SAMPLE_MAX (128u)
+
+/* Latency samples of one operation */
+struct qspi_bench_stat {
+	uint32_t count;
+	uint32_t sample_us[QSPI_BENCH_SAMPLE_MAX];
+};
+
+void qspi_bench_stat_add(struct qspi_bench_stat *stat, uint32_t elapsed_us);
+void qspi_bench_print_header(void);
+void qspi_bench_print(const char *dev, const char *op, uint32_t size,
+						struct qspi_bench_stat *stat);
+uint32_t qspi_bench_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_BENCH_H_ */
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/crc.h>
+#include <string.h>
+#include "qspi_calib.h"
+#include "qspi_ctrl.h"
+#include "qspi_norflash_test.h"
+#include "qspi_fram_test.h"
+#include "common.h"
+
+#define QSPI_CALIB_PATTERN_BYTE (256u)
+#define QSPI_CALIB_READ_COUNT (8u)
+#define QSPI_CALIB_THROUGHPUT_COUNT (64u)
+#define QSPI_CALIB_DIV_STEP_MAX (QSPI_CCR_DIV_MASK + 1)
+#define QSPI_CALIB_NOR_PATTERN_ADDR (0x00FFF000)   /* Last sector */
+#define QSPI_CALIB_RECORD_MAGIC (0x424C4351)       /* "QCLB" */
+
+struct qspi_calib_record {
+	uint32_t magic;
+	struct qspi_calib_setting setting[QSPI_CTRL_NUM];
+	uint32_t crc;
+};
+
+static uint8_t calib_pattern[QSPI_CALIB_PATTERN_BYTE];
+static uint8_t calib_read_data[QSPI_CALIB_PATTERN_BYTE];
+
+static uint32_t get_calib_base(enum QspiCtrlId ctrl)
+{
+	return qspi_ctrl_get_by_id(ctrl)->base;
+}
+
+static const char *get_calib_name(enum QspiCtrlId ctrl)
+{
+	return qspi_ctrl_get_by_id(ctrl)->name;
+}
+
+/* Toggle all data lines on every byte, and then an incremental pattern */
+static void create_calib_pattern(void)
+{
+	for (uint32_t i=0; i<QSPI_CALIB_PATTERN_BYTE/2; i++) {
+		calib_pattern[i] = (i & 0x01) ? 0xA5 : 0x5A;
+		if (i & 0x02) {
+			calib_pattern[i] = ~calib_pattern[i];
+		}
+	}
+	for (uint32_t i=QSPI_CALIB_PATTERN_BYTE/2; i<QSPI_CALIB_PATTERN_BYTE; i++) {
+		calib_pattern[i] = i;
+	}
+}
+
+static void get_calib_setting(enum QspiCtrlId ctrl, struct qspi_calib_setting *setting)
+{
+	setting->ccr = sys_read32(SCOBCA1_FPGA_QSPI_CCR(get_calib_base(ctrl)));
+	setting->dcmsr = sys_read32(SCOBCA1_FPGA_QSPI_DCMSR(get_calib_base(ctrl)));
+}
+
+static void set_calib_setting(enum QspiCtrlId ctrl, const struct qspi_calib_setting *setting)
+{
+	write32(SCOBCA1_FPGA_QSPI_CCR(get_calib_base(ctrl)), setting->ccr);
+	write32(SCOBCA1_FPGA_QSPI_DCMSR(get_calib_base(ctrl)), setting->dcmsr);
+}
+
+static bool read_calib_pattern(enum QspiCtrlId ctrl, uint8_t *buf)
+{
+	if (ctrl == QSPI_CTRL_FRAM) {
+		return qspi_fram_read(0, QSPI_FRAM_CALIB_PATTERN_ADDR, buf, QSPI_CALIB_PATTERN_BYTE);
+	}
+
+	return qspi_norflash_read_buf(get_calib_base(ctrl), 0, QSPI_CALIB_NOR_PATTERN_ADDR,
+									buf, QSPI_CALIB_PATTERN_BYTE);
+}
+
+static bool write_calib_pattern(enum QspiCtrlId ctrl)
+{
+	uint32_t base = get_calib_base(ctrl);
+
+	if (ctrl == QSPI_CTRL_FRAM) {
+		return qspi_fram_write(0, QSPI_FRAM_CALIB_PATTERN_ADDR, calib_pattern,
+								QSPI_CALIB_PATTERN_BYTE);
+	}
+
+	if (!qspi_norflash_erase(base, 0, QSPI_ERASE_SECTOR, QSPI_CALIB_NOR_PATTERN_ADDR,
+								true, NULL)) {
+		return false;
+	}
+	if (!qspi_norflash_page_program_start(base, 0, QSPI_CALIB_NOR_PATTERN_ADDR,
+											calib_pattern, QSPI_CALIB_PATTERN_BYTE)) {
+		return false;
+	}
+
+	return qspi_norflash_wait_ready(base, 0, NORFLASH_BUSY_PROGRAM, k_cycle_get_32());
+}
+
+/* Write the pattern (at the current setting) only when it is not there yet */
+static bool prepare_calib_pattern(enum QspiCtrlId ctrl)
+{
+	if (read_calib_pattern(ctrl, calib_read_data) &&
+			memcmp(calib_read_data, calib_pattern, QSPI_CALIB_PATTERN_BYTE) == 0) {
+		return true;
+	}
+
+	debug("* Write calibration pattern to %s\n", get_calib_name(ctrl));
+	if (!write_calib_pattern(ctrl)) {
+		return false;
+	}
+
+	if (!read_calib_pattern(ctrl, calib_read_data) ||
+			memcmp(calib_read_data, calib_pattern, QSPI_CALIB_PATTERN_BYTE) != 0) {
+		err("  !!! Can not write calibration pattern to %s\n", get_calib_name(ctrl));
+		return false;
+	}
+
+	return true;
+}
+
+static bool is_calib_pattern_stable(enum QspiCtrlId ctrl)
+{
+	for (uint32_t i=0; i<QSPI_CALIB_READ_COUNT; i++) {
+		memset(calib_read_data, 0x00, sizeof(calib_read_data));
+		if (!read_calib_pattern(ctrl, calib_read_data)) {
+			return false;
+		}
+		if (memcmp(calib_read_data, calib_pattern, QSPI_CALIB_PATTERN_BYTE) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static uint32_t measure_calib_read_us(enum QspiCtrlId ctrl)
+{
+	uint32_t start_cycle = k_cycle_get_32();
+
+	for (uint32_t i=0; i<QSPI_CALIB_THROUGHPUT_COUNT; i++) {
+		if (!read_calib_pattern(ctrl, calib_read_data)) {
+			return 0;
+		}
+	}
+
+	return get_elapsed_us(start_cycle);
+}
+
+/*
+ * Sweep the clock divider from the reset value to the fastest (0), and the
+ * data capture mode at each divider. The fastest divider is selected
+ * whose next faster divider also passes with the same capture mode, so
+ * that one divider step is kept as the margin. `result` is the reset
+ * setting if no faster setting is reliable.
+ */
+static bool qspi_calib_sweep(enum QspiCtrlId ctrl, struct qspi_calib_setting *result)
+{
+	struct qspi_calib_setting reset;
+	struct qspi_calib_setting setting;
+	static bool pass[QSPI_CALIB_DIV_STEP_MAX][QSPI_DCMSR_MODE_NUM];
+	uint32_t reset_div;
+	uint32_t reset_mode;
+	uint32_t step_num;
+	uint32_t mode;
+
+	get_calib_setting(ctrl, &reset);
+	*result = reset;
+	reset_div = reset.ccr & QSPI_CCR_DIV_MASK;
+	reset_mode = reset.dcmsr & QSPI_DCMSR_MODE_MASK;
+	step_num = reset_div + 1;
+
+	if (!prepare_calib_pattern(ctrl)) {
+		return false;
+	}
+
+	/* Other threads must not access the memory with the swept setting */
+	qspi_ctrl_lock(get_calib_base(ctrl));
+	info("  %s: DIV / DCMSR mode 0-%d\n", get_calib_name(ctrl), QSPI_DCMSR_MODE_NUM - 1);
+	for (uint32_t step=0; step<step_num; step++) {
+		info("  %s: %3d / ", get_calib_name(ctrl), reset_div - step);
+		for (mode=0; mode<QSPI_DCMSR_MODE_NUM; mode++) {
+			setting.ccr = (reset.ccr & ~QSPI_CCR_DIV_MASK) | (reset_div - step);
+			setting.dcmsr = (reset.dcmsr & ~QSPI_DCMSR_MODE_MASK) | mode;
+			set_calib_setting(ctrl, &setting);
+			pass[step][mode] = is_calib_pattern_stable(ctrl);
+			info("%s ", pass[step][mode] ? "OK" : "NG");
+		}
+		info("\n");
+	}
+	set_calib_setting(ctrl, &reset);
+	qspi_ctrl_unlock(get_calib_base(ctrl));
+
+	for (int32_t step=(int32_t)step_num-2; step>=0; step--) {
+		/* The reset capture mode is preferred */
+		for (uint32_t i=0; i<QSPI_DCMSR_MODE_NUM; i++) {
+			mode = (reset_mode + i) % QSPI_DCMSR_MODE_NUM;
+			if (pass[step][mode] && pass[step+1][mode]) {
+				result->ccr = (reset.ccr & ~QSPI_CCR_DIV_MASK) | (reset_div - step);
+				result->dcmsr = (reset.dcmsr & ~QSPI_DCMSR_MODE_MASK) | mode;
+				return true;
+			}
+		}
+	}
+
+	return true;
+}
+
+static uint32_t get_calib_record_crc(const struct qspi_calib_record *record)
+{
+	return crc32_ieee((const uint8_t *)record, offsetof(struct qspi_calib_record, crc));
+}
+
+/*
+ * Apply the calibration result stored on FRAM, if any. The calibration
+ * pattern is read back at the stored setting of each controller, and the
+ * reset setting is kept when it does not match (e.g. the board got
+ * slower, or the pattern was overwritten).
+ */
+bool qspi_calib_load(void)
+{
+	bool ret = true;
+	struct qspi_calib_record record;
+	struct qspi_calib_setting reset;
+
+	if (!qspi_fram_read(0, QSPI_FRAM_CALIB_RECORD_ADDR, (uint8_t *)&record, sizeof(record))) {
+		return false;
+	}
+
+	if (record.magic != QSPI_CALIB_RECORD_MAGIC || record.crc != get_calib_record_crc(&record)) {
+		debug("* QSPI calibration record is not found\n");
+		return false;
+	}
+
+	create_calib_pattern();
+	for (uint8_t i=0; i<QSPI_CTRL_NUM; i++) {
+		info("* Apply QSPI calibration to %s (CCR:0x%08x, DCMSR:0x%08x)\n",
+				get_calib_name(i), record.setting[i].ccr, record.setting[i].dcmsr);
+		qspi_ctrl_lock(get_calib_base(i));
+		get_calib_setting(i, &reset);
+		set_calib_setting(i, &record.setting[i]);
+		if (!is_calib_pattern_stable(i)) {
+			err("  !!! %s: calibration pattern mismatch, keep the reset setting\n",
+					get_calib_name(i));
+			set_calib_setting(i, &reset);
+			ret = false;
+		}
+		qspi_ctrl_unlock(get_calib_base(i));
+	}
+
+	return ret;
+}
+
+static bool store_calib_record(const struct qspi_calib_record *record)
+{
+	struct qspi_calib_record read_record;
+
+	if (!qspi_fram_write(0, QSPI_FRAM_CALIB_RECORD_ADDR, (const uint8_t *)record,
+							sizeof(*record))) {
+		return false;
+	}
+
+	if (!qspi_fram_read(0, QSPI_FRAM_CALIB_RECORD_ADDR, (uint8_t *)&read_record,
+						sizeof(read_record))) {
+		return false;
+	}
+
+	return memcmp(record, &read_record, sizeof(read_record)) == 0;
+}
+
+/*
+ *   1. Sweep Config Memory controller (Config Memory 0)
+ *   2. Sweep Data Memory controller (Data Memory 0)
+ *   3. Sweep FRAM controller (FRAM 0)
+ *   4. Store the result to FRAM record area
+ */
+uint32_t qspi_calib_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	struct qspi_calib_record record;
+	struct qspi_calib_setting reset;
+	uint32_t reset_us;
+	uint32_t calib_us;
+
+	info("* [%d] Start QSPI Clock Calibration\n", test_no);
+
+	create_calib_pattern();
+	record.magic = QSPI_CALIB_RECORD_MAGIC;
+
+	for (uint8_t i=0; i<QSPI_CTRL_NUM; i++) {
+		info("* [%d-%d] Start %s controller calibration\n", test_no, i + 1, get_calib_name(i));
+		get_calib_setting(i, &reset);
+		if (!qspi_calib_sweep(i, &record.setting[i])) {
+			assert();
+			err_cnt++;
+			goto end_of_test;
+		}
+
+		reset_us = measure_calib_read_us(i);
+		set_calib_setting(i, &record.setting[i]);
+		calib_us = measure_calib_read_us(i);
+
+		info("  %s: CCR 0x%08x -> 0x%08x, DCMSR 0x%08x -> 0x%08x\n", get_calib_name(i),
+				reset.ccr, record.setting[i].ccr, reset.dcmsr, record.setting[i].dcmsr);
+		qspi_print_throughput("Reset setting read", QSPI_CALIB_PATTERN_BYTE *
+								QSPI_CALIB_THROUGHPUT_COUNT, reset_us);
+		qspi_print_throughput("Calibrated setting read", QSPI_CALIB_PATTERN_BYTE *
+								QSPI_CALIB_THROUGHPUT_COUNT, calib_us);
+	}
+
+	info("* [%d-%d] Store the result to FRAM (0x%08x)\n", test_no, QSPI_CTRL_NUM + 1,
+			QSPI_FRAM_CALIB_RECORD_ADDR);
+	record.crc = get_calib_record_crc(&record);
+	if (!store_calib_record(&record)) {
+		assert();
+		err_cnt++;
+	}
+
+end_of_test:
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
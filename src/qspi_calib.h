@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_CALIB_H_
+#define SCOBCA1_FPGA_TEST_QSPI_CALIB_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+struct qspi_calib_setting {
+	uint32_t ccr;
+	uint32_t dcmsr;
+};
+
+bool qspi_calib_load(void);
+uint32_t qspi_calib_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_CALIB_H_ */
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/console/console.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+#include <stdlib.h>
+#include "qspi_cfgmem_program.h"
+#include "hrmem_test.h"
+#include "common.h"
+
+#define CFGMEM_PROGRAM_LINE_MAX_BYTE (32u)
+#define CFGMEM_PROGRAM_LINE_MAX_CHAR (CFGMEM_PROGRAM_LINE_MAX_BYTE * 2)
+#define CFGMEM_PROGRAM_ERASE_POLL_US (100u)
+#define CFGMEM_PROGRAM_RX_TIMEOUT_MS (10000u)
+#define CFGMEM_PROGRAM_RX_STACK_SIZE (1024u)
+#define CFGMEM_PROGRAM_RX_THREAD_PRIORITY (7u)
+#define QSPI_NOR_FLASH_MEM_BYTE (16*1024*1024)
+
+struct cfgmem_line {
+	char s[CFGMEM_PROGRAM_LINE_MAX_CHAR + 1];
+};
+
+K_THREAD_STACK_DEFINE(_cfgmem_rx_thread_stack, CFGMEM_PROGRAM_RX_STACK_SIZE);
+static struct k_thread _k_thread_data;
+K_MSGQ_DEFINE(cfgmem_line_msgq, sizeof(struct cfgmem_line), 1, 4);
+
+/*
+ * console_getline() has no timeout, so the image lines are received on
+ * this thread, and the test waits for them with a timeout. A line too
+ * long for the buffer is passed as an empty line, which is rejected.
+ */
+static void cfgmem_rx_thread(void *p1, void *p2, void *p3)
+{
+	struct cfgmem_line line;
+	char *s;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		s = console_getline();
+		if (strlen(s) > CFGMEM_PROGRAM_LINE_MAX_CHAR) {
+			line.s[0] = '\0';
+		} else {
+			strcpy(line.s, s);
+		}
+		k_msgq_put(&cfgmem_line_msgq, &line, K_FOREVER);
+	}
+}
+
+void qspi_config_memory_program_init(struct cfgmem_program *prog, uint8_t mem_no,
+									uint32_t mem_addr, const uint8_t *image, uint32_t size)
+{
+	prog->mem_no = mem_no;
+	prog->mem_addr = mem_addr;
+	prog->image = image;
+	prog->size = size;
+	prog->received = 0;
+	prog->erased = 0;
+	prog->programmed = 0;
+	prog->is_busy = false;
+}
+
+/*
+ * Advance the pipeline without waiting. The received page is programmed
+ * when its block is erased, otherwise the next block is erased.
+ */
+bool qspi_config_memory_program_step(struct cfgmem_program *prog)
+{
+	uint32_t base = SCOBCA1_FPGA_CFG_BASE_ADDR;
+	uint32_t write_size;
+	bool is_ready = false;
+
+	if (prog->is_busy) {
+		if (!qspi_norflash_poll_ready(base, prog->mem_no, prog->busy_op,
+										prog->busy_cycle, &is_ready)) {
+			return false;
+		}
+		if (!is_ready) {
+			return true;
+		}
+		prog->is_busy = false;
+	}
+
+	/* Page Program behind the received data */
+	write_size = MIN(QSPI_NOR_FLASH_PAGE_BYTE, prog->size - prog->programmed);
+	if (write_size > 0 && prog->programmed < prog->erased &&
+			prog->received - prog->programmed >= write_size) {
+		if (!qspi_norflash_page_program_start(base, prog->mem_no,
+												prog->mem_addr + prog->programmed,
+												&prog->image[prog->programmed], write_size)) {
+			return false;
+		}
+		prog->programmed += write_size;
+		prog->is_busy = true;
+		prog->busy_op = NORFLASH_BUSY_PROGRAM;
+		prog->busy_cycle = k_cycle_get_32();
+		return true;
+	}
+
+	/* Erase ahead of the write cursor */
+	if (prog->erased < prog->size) {
+		if (!qspi_norflash_erase(base, prog->mem_no, QSPI_ERASE_BLOCK,
+									prog->mem_addr + prog->erased, false, NULL)) {
+			return false;
+		}
+		prog->erased += QSPI_NOR_FLASH_BLOCK_BYTE;
+		prog->is_busy = true;
+		prog->busy_op = NORFLASH_BUSY_BLOCK_ERASE;
+		prog->busy_cycle = k_cycle_get_32();
+	}
+
+	return true;
+}
+
+/* Program the rest of the received image and wait for the completion */
+bool qspi_config_memory_program_finish(struct cfgmem_program *prog)
+{
+	while (prog->programmed < prog->received || prog->is_busy) {
+		if (!qspi_config_memory_program_step(prog)) {
+			return false;
+		}
+		if (prog->is_busy && prog->busy_op != NORFLASH_BUSY_PROGRAM) {
+			k_usleep(CFGMEM_PROGRAM_ERASE_POLL_US);
+		}
+	}
+
+	return true;
+}
+
+/*
+ *   1. Receive header `<mem no> <size> <crc32 (hex)>` from UART
+ *   2. Receive image in hex to HRMEM, and Erase/Program Config Memory
+ *   3. Program the rest of image
+ *   4. Verify CRC of Config Memory
+ *
+ * `ACK <received byte>` is sent for the header and each image line, and
+ * the sender must wait for it before the next line (flow control).
+ */
+uint32_t qspi_config_memory_program_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t mem_addr = 0x00000000;
+	uint8_t *image = (uint8_t *)(SCOBCA1_FPGA_HRMEM_MIRROR_BASE_ADDR + HRMEM_IMAGE_MEM_ADDR);
+	uint8_t line_data[CFGMEM_PROGRAM_LINE_MAX_BYTE];
+	struct cfgmem_line line;
+	struct cfgmem_program prog;
+	uint32_t mem_no;
+	uint32_t size;
+	uint32_t exp_crc;
+	uint32_t crc = 0;
+	uint32_t start_cycle;
+	uint32_t receive_us;
+	uint32_t total_us;
+	size_t count;
+	char *s;
+	k_tid_t tid = NULL;
+
+	info("* [%d] Start QSPI Config Memory Programming\n", test_no);
+	info("Please input `<mem no> <size> <crc32 (hex)>`, and then image in hex (%d byte per line)\n",
+			CFGMEM_PROGRAM_LINE_MAX_BYTE);
+	info("> ");
+
+	s = console_getline();
+	mem_no = strtoul(s, &s, 10);
+	size = strtoul(s, &s, 10);
+	exp_crc = strtoul(s, NULL, 16);
+	if (mem_no > 1 || size == 0 || size > HRMEM_IMAGE_MEM_SIZE ||
+			size > QSPI_NOR_FLASH_MEM_BYTE - mem_addr) {
+		err("   Invalid header (mem no: %d, size: %d)\n", mem_no, size);
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-1] Receive image and Erase/Program Config Memory [%d] (%d byte)\n",
+			test_no, mem_no, size);
+	qspi_config_memory_program_init(&prog, mem_no, mem_addr, image, size);
+	k_msgq_purge(&cfgmem_line_msgq);
+	tid = k_thread_create(&_k_thread_data, _cfgmem_rx_thread_stack, CFGMEM_PROGRAM_RX_STACK_SIZE,
+					cfgmem_rx_thread, NULL, NULL, NULL,
+					CFGMEM_PROGRAM_RX_THREAD_PRIORITY, 0, K_NO_WAIT);
+	start_cycle = k_cycle_get_32();
+	info("ACK %d\n", prog.received);
+	while (prog.received < size) {
+		if (k_msgq_get(&cfgmem_line_msgq, &line, K_MSEC(CFGMEM_PROGRAM_RX_TIMEOUT_MS)) != 0) {
+			err("  !!! Image receive timeout at %d byte\n", prog.received);
+			err_cnt++;
+			goto end_of_test;
+		}
+		count = hex2bin(line.s, strlen(line.s), line_data, sizeof(line_data));
+		if (count == 0 || count > size - prog.received) {
+			err("   Invalid image line at %d byte\n", prog.received);
+			err_cnt++;
+			goto end_of_test;
+		}
+		memcpy(&image[prog.received], line_data, count);
+		prog.received += count;
+
+		if (!qspi_config_memory_program_step(&prog)) {
+			assert();
+			err_cnt++;
+			goto end_of_test;
+		}
+		info("ACK %d\n", prog.received);
+	}
+	receive_us = get_elapsed_us(start_cycle);
+	k_thread_abort(tid);
+	tid = NULL;
+
+	info("* [%d-2] Program the rest of image (%d byte)\n", test_no, size - prog.programmed);
+	if (!qspi_config_memory_program_finish(&prog)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	total_us = get_elapsed_us(start_cycle);
+
+	info("* [%d-3] Verify image CRC\n", test_no);
+	if (crc32_ieee(image, size) != exp_crc) {
+		err("  !!! Received image CRC mismatch (exp:0x%08x)\n", exp_crc);
+		assert();
+		err_cnt++;
+	}
+	if (!qspi_norflash_read_crc(SCOBCA1_FPGA_CFG_BASE_ADDR, mem_no, mem_addr, size, &crc)) {
+		assert();
+		err_cnt++;
+	} else if (crc != exp_crc) {
+		err("  !!! Config Memory CRC mismatch 0x%08x (exp:0x%08x)\n", crc, exp_crc);
+		assert();
+		err_cnt++;
+	}
+
+	qspi_print_throughput("Config Memory receive", size, receive_us);
+	qspi_print_throughput("Config Memory programming", size, total_us);
+	info("* Programming after receive: %d us\n", total_us - receive_us);
+
+end_of_test:
+	if (tid != NULL) {
+		k_thread_abort(tid);
+	}
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
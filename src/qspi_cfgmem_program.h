@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_CFGMEM_PROGRAM_H_
+#define SCOBCA1_FPGA_TEST_QSPI_CFGMEM_PROGRAM_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_norflash_test.h"
+
+/*
+ * Config Memory programming pipeline. Blocks are erased ahead of the
+ * write cursor, and the received image is page programmed behind it.
+ */
+struct cfgmem_program {
+	uint8_t mem_no;
+	uint32_t mem_addr;     /* Block aligned */
+	const uint8_t *image;  /* Image buffer on HRMEM */
+	uint32_t size;
+	uint32_t received;     /* Valid image size in the buffer */
+	uint32_t erased;       /* Erase cursor (offset from mem_addr) */
+	uint32_t programmed;   /* Write cursor (offset from mem_addr) */
+	bool is_busy;
+	enum NorflashBusyOp busy_op;
+	uint32_t busy_cycle;
+};
+
+void qspi_config_memory_program_init(struct cfgmem_program *prog, uint8_t mem_no,
+									uint32_t mem_addr, const uint8_t *image, uint32_t size);
+bool qspi_config_memory_program_step(struct cfgmem_program *prog);
+bool qspi_config_memory_program_finish(struct cfgmem_program *prog);
+uint32_t qspi_config_memory_program_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_CFGMEM_PROGRAM_H_ */
@@ -4,25 +4,42 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <zephyr/sys/crc.h>
 #include "qspi_norflash_test.h"
 #include "qspi_fram_test.h"
+#include "qspi_calib.h"
+#include "qspi_norflash_wear.h"
 #include "common.h"
 
 uint32_t qspi_init(uint32_t test_no)
 {
 	uint32_t err_cnt = 0;
+	uint32_t start_cycle;
 
 	printk("* [%d] Start QSPI Initializing\n", test_no);
 
-	err_cnt += qspi_norflash_initialize(test_no);
+	/* FRAM is initialized while NOR flash is writing the register */
+	start_cycle = k_cycle_get_32();
+	qspi_norflash_initialize_start(test_no);
 	err_cnt += qspi_fram_initialize(test_no);
+	err_cnt += qspi_norflash_initialize_finish(test_no);
+	info("* QSPI initialized (%d us)\n", get_elapsed_us(start_cycle));
+
+	/*
+	 * Apply the result of QSPI Clock Calibration, and restore the NOR
+	 * flash wear record of the previous boot
+	 */
+	if (err_cnt == 0) {
+		qspi_calib_load();
+		qspi_norflash_wear_load();
+	}
 
 	print_result(test_no, err_cnt);
 
 	return err_cnt;
 }
 
-uint32_t qspi_create_fifo_data(uint8_t start_val, uint32_t *data, size_t size, bool fill)
+uint32_t qspi_create_fifo_data(uint8_t start_val, uint8_t *data, size_t size, bool fill)
 {
 	for (uint32_t i=0; i<size; i++) {
 		data[i] = start_val;
@@ -33,3 +50,34 @@ uint32_t qspi_create_fifo_data(uint8_t start_val, uint32_t *data, size_t size, b
 
 	return start_val;
 }
+
+/*
+ * CRC32 of the data created by qspi_create_fifo_data(), which is used to
+ * verify the read data without comparing each byte.
+ */
+uint32_t qspi_create_fifo_data_crc(uint8_t start_val, size_t size, bool fill)
+{
+	uint8_t data[QSPI_NOR_FLASH_PAGE_BYTE];
+	uint32_t crc = 0;
+	size_t chunk;
+
+	while (size > 0) {
+		chunk = MIN(size, sizeof(data));
+		start_val = qspi_create_fifo_data(start_val, data, chunk, fill);
+		crc = crc32_ieee_update(crc, data, chunk);
+		size -= chunk;
+	}
+
+	return crc;
+}
+
+void qspi_print_throughput(const char *name, uint32_t size, uint32_t elapsed_us)
+{
+	if (elapsed_us == 0) {
+		elapsed_us = 1;
+	}
+
+	/* byte/us is equal to MB/s */
+	info("* %s %d byte: %d us (%.3f MB/s)\n", name, size, elapsed_us,
+			(double)size / elapsed_us);
+}
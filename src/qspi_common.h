@@ -28,38 +28,43 @@
 #define QSPI_FTLSR_OFFSET  (0x0038) /* QSPI FIFO Threshold Level Setting Register */
 #define QSPI_VER_OFFSET    (0xF000) /* QSPI Controller IP Version Register */
 
-/* QSPI Control Register for Data/ Configutation Memory */
-#define SCOBCA1_FPGA_NORFLASH_QSPI_ACR(base) (base +  QSPI_ACR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base) (base + QSPI_TDR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_RDR(base) (base +  QSPI_RDR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_ASR(base) (base + QSPI_ASR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_FIFOSR(base) (base + QSPI_FIFOSR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_FIFORR(base) (base + QSPI_FIFORR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_ISR(base) (base + QSPI_ISR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_IER(base) (base + QSPI_IER_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_CCR(base) (base + QSPI_CCR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_DCMSR(base) (base + QSPI_DCMSR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_FTLSR(base) (base + QSPI_FTLSR_OFFSET)
-#define SCOBCA1_FPGA_NORFLASH_QSPI_VER(base) (base + QSPI_VER_OFFSET)
-
-/* QSPI Control Register for FeRAM */
-#define SCOBCA1_FPGA_FRAM_QSPI_ACR (SCOBCA1_FPGA_FRAM_BASE_ADDR +  QSPI_ACR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_TDR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_TDR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_RDR (SCOBCA1_FPGA_FRAM_BASE_ADDR +  QSPI_RDR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_ASR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_ASR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_FIFOSR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_FIFOSR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_FIFORR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_FIFORR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_ISR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_ISR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_IER (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_IER_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_CCR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_CCR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_DCMSR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_DCMSR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_FTLSR (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_FTLSR_OFFSET)
-#define SCOBCA1_FPGA_FRAM_QSPI_VER (SCOBCA1_FPGA_FRAM_BASE_ADDR + QSPI_VER_OFFSET)
+/* QSPI Control Register for Config/Data Memory and FRAM */
+#define SCOBCA1_FPGA_QSPI_ACR(base) (base + QSPI_ACR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_TDR(base) (base + QSPI_TDR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_RDR(base) (base + QSPI_RDR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_ASR(base) (base + QSPI_ASR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_FIFOSR(base) (base + QSPI_FIFOSR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_FIFORR(base) (base + QSPI_FIFORR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_ISR(base) (base + QSPI_ISR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_IER(base) (base + QSPI_IER_OFFSET)
+#define SCOBCA1_FPGA_QSPI_CCR(base) (base + QSPI_CCR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_DCMSR(base) (base + QSPI_DCMSR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_FTLSR(base) (base + QSPI_FTLSR_OFFSET)
+#define SCOBCA1_FPGA_QSPI_VER(base) (base + QSPI_VER_OFFSET)
+
+/* QSPI FIFO Status Register */
+#define QSPI_FIFOSR_TX_LEVEL_MASK  (0x0000001F) /* TX FIFO data count */
+#define QSPI_FIFOSR_RX_LEVEL_MASK  (0x001F0000) /* RX FIFO data count */
+#define QSPI_FIFOSR_RX_LEVEL_SHIFT (16u)
+
+/* QSPI FIFO Threshold Level Setting Register */
+#define QSPI_FTLSR_TX_SHIFT (0u)
+#define QSPI_FTLSR_RX_SHIFT (16u)
+
+/* QSPI Clock Control Register */
+#define QSPI_CCR_DIV_MASK (0x000000FF) /* SPI clock divider */
+
+/* QSPI Data Capture Mode Setting Register */
+#define QSPI_DCMSR_MODE_MASK (0x00000003) /* Data capture timing */
+#define QSPI_DCMSR_MODE_NUM  (4u)
+
+#define QSPI_FIFO_DEPTH (16u)
 
 #define QSPI_DATA_MEM0 (0u)
 #define QSPI_DATA_MEM1 (1u)
 #define QSPI_CFG_MEM0  (0u)
 #define QSPI_CFG_MEM1  (1u)
+#define QSPI_NOR_FLASH_PAGE_BYTE   (256u)
 #define QSPI_NOR_FLASH_SECTOR_BYTE (4*1024)
 #define QSPI_NOR_FLASH_BLOCK_BYTE  (64*1024)
 
@@ -68,9 +73,18 @@ enum QspiEraseType
 	QSPI_ERASE_SECTOR,      /* 4KB */
 	QSPI_ERASE_HALF_BLOCK,  /* 32KB */
 	QSPI_ERASE_BLOCK,       /* 64KB */
+	QSPI_ERASE_TYPE_NUM,
 };
 
+/* Called for each RX data burst drained from RX FIFO */
+typedef bool (*qspi_read_sink_t)(const uint8_t *data, size_t size, void *arg);
+
+/* Called to fill each TX data burst pushed into TX FIFO */
+typedef bool (*qspi_write_source_t)(uint8_t *data, size_t size, void *arg);
+
 uint32_t qspi_init(uint32_t test_no);
-uint32_t qspi_create_fifo_data(uint8_t start_val, uint32_t *data, size_t size, bool fill);
+uint32_t qspi_create_fifo_data(uint8_t start_val, uint8_t *data, size_t size, bool fill);
+uint32_t qspi_create_fifo_data_crc(uint8_t start_val, size_t size, bool fill);
+void qspi_print_throughput(const char *name, uint32_t size, uint32_t elapsed_us);
 
 #endif /* SCOBCA1_FPGA_TEST_QSPI_COMMON_H_ */
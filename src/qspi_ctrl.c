@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "qspi_ctrl.h"
+#include "qspi_norflash_test.h"
+#include "qspi_fram_test.h"
+#include "qspi_async.h"
+#include "common.h"
+
+#define QSPI_CTRL_BASE_STRIDE (0x00100000)
+#define QSPI_ASR_IDLE (0x00)
+#define QSPI_SFDP_DUMMY_BYTE (1u)   /* 8 clocks in SINGLE-IO */
+#define QSPI_ISR_CONTROL_DONE (0x01)
+#define QSPI_SR1_WEL (0x02)
+#define QSPI_POLL_INTERVAL_US (1u)
+
+/*
+ * A command sequence of a memory (e.g. Write Enable, Page Program and
+ * WIP polling) must not be interleaved with another thread, so the
+ * driver, the async thread, the scheduler and the tests take the lock of
+ * the controller on each API. Config Memory 0/1 also share CFGMEMSEL.
+ */
+static K_MUTEX_DEFINE(qspi_cfg_lock);
+static K_MUTEX_DEFINE(qspi_data_lock);
+static K_MUTEX_DEFINE(qspi_fram_lock);
+
+/*
+ * All three QSPI controllers are the same IP, and only the memories
+ * behind them are different. Config Memory 0/1 share SPI SS 0, and are
+ * switched by CFGMEMSEL.
+ */
+static const struct qspi_ctrl qspi_ctrl[QSPI_CTRL_NUM] = {
+	[QSPI_CTRL_CFG] = {
+		.name = "Config Memory",
+		.base = SCOBCA1_FPGA_CFG_BASE_ADDR,
+		.spi_ss = {0x01, 0x01},
+		.idle_retry = REG_READ_RETRY(10),
+		.spin_retry = 10000,
+		.lock = &qspi_cfg_lock,
+		.ops = &qspi_norflash_ops,
+	},
+	[QSPI_CTRL_DATA] = {
+		.name = "Data Memory",
+		.base = SCOBCA1_FPGA_DATA_BASE_ADDR,
+		.spi_ss = {0x01, 0x02},
+		.idle_retry = REG_READ_RETRY(10),
+		.spin_retry = 10000,
+		.lock = &qspi_data_lock,
+		.ops = &qspi_norflash_ops,
+	},
+	[QSPI_CTRL_FRAM] = {
+		.name = "FRAM",
+		.base = SCOBCA1_FPGA_FRAM_BASE_ADDR,
+		.spi_ss = {0x01, 0x02},
+		.idle_retry = REG_READ_RETRY(10),
+		.spin_retry = 10000,
+		.lock = &qspi_fram_lock,
+		.ops = &qspi_fram_ops,
+	},
+};
+
+/* The controllers are mapped every 1MB from Config Memory */
+const struct qspi_ctrl *qspi_ctrl_get(uint32_t base)
+{
+	return qspi_ctrl_get_by_id((base - SCOBCA1_FPGA_CFG_BASE_ADDR) / QSPI_CTRL_BASE_STRIDE);
+}
+
+const struct qspi_ctrl *qspi_ctrl_get_by_id(enum QspiCtrlId id)
+{
+	if (id >= QSPI_CTRL_NUM) {
+		return NULL;
+	}
+
+	return &qspi_ctrl[id];
+}
+
+/* The lock is recursive, so an API can call another API with it held */
+void qspi_ctrl_lock(uint32_t base)
+{
+	k_mutex_lock(qspi_ctrl_get(base)->lock, K_FOREVER);
+}
+
+void qspi_ctrl_unlock(uint32_t base)
+{
+	k_mutex_unlock(qspi_ctrl_get(base)->lock);
+}
+
+bool qspi_ctrl_is_idle(uint32_t base)
+{
+	const struct qspi_ctrl *ctrl = qspi_ctrl_get(base);
+
+	debug("* Confirm QSPI Access Status is `Idle`\n");
+	if (!assert32(SCOBCA1_FPGA_QSPI_ASR(base), QSPI_ASR_IDLE, ctrl->idle_retry)) {
+		err("QSPI (%s) is busy, so exit test\n", ctrl->name);
+		return false;
+	}
+
+	return true;
+}
+
+bool qspi_ctrl_activate(uint32_t base, uint32_t spi_mode)
+{
+	debug("* Activate SPI SS with %08x\n", spi_mode);
+	write32(SCOBCA1_FPGA_QSPI_ACR(base), spi_mode);
+	if (!qspi_ctrl_is_idle(base)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool qspi_ctrl_inactivate(uint32_t base)
+{
+	if (qspi_async_is_irq_mode(base)) {
+		/* Discard SPI Control Done of the previous access */
+		qspi_async_clear_control_done(base);
+	}
+
+	debug("* Inactivate SPI SS\n");
+	write32(SCOBCA1_FPGA_QSPI_ACR(base), 0x00000000);
+	if (!qspi_ctrl_is_idle(base)) {
+		return false;
+	}
+
+	return true;
+}
+
+bool qspi_ctrl_is_control_done(uint32_t base)
+{
+	if (qspi_async_is_irq_mode(base)) {
+		debug("* Wait QSPI Interrupt `SPI Control Done`\n");
+		if (!qspi_async_wait_control_done(base)) {
+			assert();
+			return false;
+		}
+
+		return true;
+	}
+
+	debug("* Confirm QSPI Interrupt Stauts is `SPI Control Done`\n");
+	if (!assert32(SCOBCA1_FPGA_QSPI_ISR(base), 0x01, REG_READ_RETRY(10))) {
+		assert();
+		return false;
+	}
+
+	debug("* Clear QSPI Interrupt Stauts\n");
+	write32(SCOBCA1_FPGA_QSPI_ISR(base), 0x01);
+	if (!assert32(SCOBCA1_FPGA_QSPI_ISR(base), 0x00, REG_READ_RETRY(10))) {
+		assert();
+		return false;
+	}
+
+	return true;
+}
+
+void qspi_ctrl_write_addr(uint32_t base, uint32_t mem_addr)
+{
+	write32(SCOBCA1_FPGA_QSPI_TDR(base), (mem_addr & 0x00FF0000) >> 16);
+	write32(SCOBCA1_FPGA_QSPI_TDR(base), (mem_addr & 0x0000FF00) >> 8);
+	write32(SCOBCA1_FPGA_QSPI_TDR(base), (mem_addr & 0x000000FF));
+}
+
+bool qspi_ctrl_send_dummy(uint32_t base, uint8_t dummy_count)
+{
+	debug("* Send dummy cycle %d byte\n", dummy_count);
+	for (uint8_t i=0; i<dummy_count; i++) {
+		write32(SCOBCA1_FPGA_QSPI_RDR(base), 0x00);
+	}
+
+	if (!qspi_ctrl_is_idle(base)) {
+		assert();
+		return false;
+	}
+
+	debug("* Discard dummy data\n");
+	for (uint8_t i=0; i<dummy_count; i++) {
+		sys_read32(SCOBCA1_FPGA_QSPI_RDR(base));
+	}
+
+	return true;
+}
+
+bool qspi_ctrl_read_and_verify(uint32_t base, size_t exp_size, const uint8_t *exp_val)
+{
+	bool ret = true;
+
+	debug("* Reqest RX FIFO %d byte\n", exp_size);
+	for (uint8_t i=0; i<exp_size; i++) {
+		write32(SCOBCA1_FPGA_QSPI_RDR(base), 0x00);
+	}
+
+	if (!qspi_ctrl_is_idle(base)) {
+		assert();
+		return false;
+	}
+
+	debug("* Read RX FIFO %d byte and verify the value\n", exp_size);
+	for (uint8_t i=0; i<exp_size; i++) {
+		if (!assert32(SCOBCA1_FPGA_QSPI_RDR(base), exp_val[i],
+						REG_READ_RETRY(0))) {
+			ret = false;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * Request `skip` + `size` byte from RX FIFO, and drop the first `skip`
+ * byte (dummy cycle) before the data. The data is stored into `buf`
+ * directly, or passed through a FIFO sized bounce buffer without `buf`.
+ * `sink` (optional) is called for each RX data burst.
+ */
+static bool drain_rx(uint32_t base, uint32_t skip, uint32_t size, uint8_t *buf,
+						qspi_read_sink_t sink, void *arg)
+{
+	const struct qspi_ctrl *ctrl = qspi_ctrl_get(base);
+	bool ret = true;
+	uint8_t rx_data[QSPI_FIFO_DEPTH];
+	uint8_t *data = buf != NULL ? buf : rx_data;
+	uint32_t total = skip + size;
+	uint32_t requested = 0;
+	uint32_t received = 0;
+	uint32_t empty_count = 0;
+	uint32_t level;
+	uint8_t count = 0;
+
+	debug("* Stream RX FIFO %d byte\n", size);
+	while (received < total) {
+		while (requested < total && requested - received < QSPI_FIFO_DEPTH) {
+			sys_write32(0x00, SCOBCA1_FPGA_QSPI_RDR(base));
+			requested++;
+		}
+
+		level = (sys_read32(SCOBCA1_FPGA_QSPI_FIFOSR(base)) &
+					QSPI_FIFOSR_RX_LEVEL_MASK) >> QSPI_FIFOSR_RX_LEVEL_SHIFT;
+		if (level == 0) {
+			if (++empty_count > ctrl->spin_retry) {
+				err("  !!! QSPI (%s) RX FIFO is empty (%d/%d byte)\n",
+						ctrl->name, received, total);
+				return false;
+			}
+			continue;
+		}
+		empty_count = 0;
+
+		for (uint32_t i=0; i<level; i++) {
+			if (received++ < skip) {
+				sys_read32(SCOBCA1_FPGA_QSPI_RDR(base));
+				continue;
+			}
+			data[count++] = sys_read32(SCOBCA1_FPGA_QSPI_RDR(base));
+			if (count == QSPI_FIFO_DEPTH || received == total) {
+				if (sink != NULL && !sink(data, count, arg)) {
+					ret = false;
+				}
+				if (buf != NULL) {
+					data += count;
+				}
+				count = 0;
+			}
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * Poll Access Status without the retry log of assert32(). The poll
+ * interval bounds the timeout to `spin_retry` microseconds.
+ */
+static bool wait_idle(uint32_t base)
+{
+	const struct qspi_ctrl *ctrl = qspi_ctrl_get(base);
+
+	for (uint32_t i=0; i<ctrl->spin_retry; i++) {
+		if (sys_read32(SCOBCA1_FPGA_QSPI_ASR(base)) == QSPI_ASR_IDLE) {
+			return true;
+		}
+		k_busy_wait(QSPI_POLL_INTERVAL_US);
+	}
+
+	err("  !!! QSPI (%s) is busy\n", ctrl->name);
+	return false;
+}
+
+static bool wait_control_done(uint32_t base)
+{
+	const struct qspi_ctrl *ctrl = qspi_ctrl_get(base);
+
+	if (qspi_async_is_irq_mode(base)) {
+		return qspi_async_wait_control_done(base);
+	}
+
+	for (uint32_t i=0; i<ctrl->spin_retry; i++) {
+		if (sys_read32(SCOBCA1_FPGA_QSPI_ISR(base)) & QSPI_ISR_CONTROL_DONE) {
+			sys_write32(QSPI_ISR_CONTROL_DONE, SCOBCA1_FPGA_QSPI_ISR(base));
+			return true;
+		}
+		k_busy_wait(QSPI_POLL_INTERVAL_US);
+	}
+
+	err("  !!! QSPI (%s) SPI Control is not done\n", ctrl->name);
+	return false;
+}
+
+/*
+ * Top up TX FIFO, and wait until all data is sent before SPI SS is
+ * released. Without `data`, the TX data is filled by `source` into a
+ * FIFO sized bounce buffer.
+ */
+static bool push_tx(uint32_t base, const uint8_t *data, uint32_t size,
+						qspi_write_source_t source, void *arg)
+{
+	const struct qspi_ctrl *ctrl = qspi_ctrl_get(base);
+	uint8_t tx_data[QSPI_FIFO_DEPTH];
+	uint32_t pos = 0;
+	uint32_t filled = 0;
+	uint32_t full_count = 0;
+	uint32_t level;
+	uint32_t count;
+
+	while (pos < size) {
+		if (data == NULL && pos == filled) {
+			count = MIN(sizeof(tx_data), size - pos);
+			if (!source(tx_data, count, arg)) {
+				return false;
+			}
+			filled += count;
+		}
+
+		level = sys_read32(SCOBCA1_FPGA_QSPI_FIFOSR(base)) & QSPI_FIFOSR_TX_LEVEL_MASK;
+		count = MIN(QSPI_FIFO_DEPTH - level, (data != NULL ? size : filled) - pos);
+		if (count == 0) {
+			if (++full_count > ctrl->spin_retry) {
+				err("  !!! QSPI (%s) TX FIFO is full (%d/%d byte)\n",
+						ctrl->name, pos, size);
+				return false;
+			}
+			continue;
+		}
+		full_count = 0;
+
+		for (uint32_t i=0; i<count; i++) {
+			if (data != NULL) {
+				sys_write32(data[pos], SCOBCA1_FPGA_QSPI_TDR(base));
+			} else {
+				sys_write32(tx_data[pos % sizeof(tx_data)], SCOBCA1_FPGA_QSPI_TDR(base));
+			}
+			pos++;
+		}
+	}
+
+	return wait_idle(base);
+}
+
+/*
+ * Run the whole command through the FIFOs. Access Status is waited only
+ * where the hardware requires it: before switching to QUAD-IO (the
+ * previous bytes must be shifted out in SINGLE-IO) and before releasing
+ * SPI SS after TX data. SPI SS is always released, also on error.
+ */
+bool qspi_ctrl_exec(uint32_t base, uint32_t spi_ss, const struct qspi_cmd *cmd)
+{
+	bool ret = true;
+	uint32_t skip = cmd->dummy_byte;
+
+	debug("* QSPI command 0x%02x (addr:0x%06x, %d byte)\n", cmd->opcode, cmd->addr, cmd->size);
+	sys_write32(spi_ss, SCOBCA1_FPGA_QSPI_ACR(base));
+	sys_write32(cmd->opcode, SCOBCA1_FPGA_QSPI_TDR(base));
+
+	if (cmd->io == QSPI_IO_1_4_4) {
+		ret = wait_idle(base);
+		if (!ret) {
+			goto release;
+		}
+		sys_write32(QSPI_SPI_MODE_QUAD + spi_ss, SCOBCA1_FPGA_QSPI_ACR(base));
+	}
+
+	for (int8_t i=cmd->addr_byte-1; i>=0; i--) {
+		sys_write32((cmd->addr >> (i * 8)) & 0xFF, SCOBCA1_FPGA_QSPI_TDR(base));
+	}
+	for (uint8_t i=0; i<cmd->mode_byte; i++) {
+		sys_write32(0x00, SCOBCA1_FPGA_QSPI_TDR(base));
+	}
+
+	/* Dummy cycle is sent in SINGLE-IO before the data in QUAD-IO */
+	if (cmd->io == QSPI_IO_1_1_4 && cmd->dir != QSPI_CMD_DIR_NONE) {
+		ret = drain_rx(base, skip, 0, NULL, NULL, NULL) && wait_idle(base);
+		if (!ret) {
+			goto release;
+		}
+		sys_write32(QSPI_SPI_MODE_QUAD + spi_ss, SCOBCA1_FPGA_QSPI_ACR(base));
+		skip = 0;
+	}
+
+	switch (cmd->dir) {
+	case QSPI_CMD_DIR_TX:
+		ret = push_tx(base, cmd->tx_data, cmd->size, cmd->source, cmd->arg);
+		break;
+	case QSPI_CMD_DIR_RX:
+		ret = drain_rx(base, skip, cmd->size, cmd->rx_buf, cmd->sink, cmd->arg);
+		break;
+	default:
+		ret = wait_idle(base);
+		break;
+	}
+
+release:
+	if (qspi_async_is_irq_mode(base)) {
+		/* Discard SPI Control Done of the previous access */
+		qspi_async_clear_control_done(base);
+	}
+	sys_write32(0x00000000, SCOBCA1_FPGA_QSPI_ACR(base));
+
+	if (cmd->is_control_done) {
+		if (!wait_control_done(base)) {
+			return false;
+		}
+	} else {
+		if (!wait_idle(base)) {
+			return false;
+		}
+		/*
+		 * SPI Control Done is set also for this command, so clear it
+		 * not to be seen by the next qspi_ctrl_is_control_done()
+		 */
+		if (!qspi_async_is_irq_mode(base)) {
+			sys_write32(QSPI_ISR_CONTROL_DONE, SCOBCA1_FPGA_QSPI_ISR(base));
+		}
+	}
+
+	return ret;
+}
+
+/* Send a single byte instruction with SINGLE-IO */
+bool qspi_ctrl_send_command(uint32_t base, uint32_t spi_ss, uint8_t cmd)
+{
+	struct qspi_cmd qspi_cmd = {
+		.opcode = cmd,
+		.is_control_done = true,
+	};
+
+	return qspi_ctrl_exec(base, spi_ss, &qspi_cmd);
+}
+
+bool qspi_ctrl_read_register(uint32_t base, uint32_t spi_ss, uint8_t cmd, uint8_t *val)
+{
+	struct qspi_cmd qspi_cmd = {
+		.opcode = cmd,
+		.dir = QSPI_CMD_DIR_RX,
+		.size = 1,
+		.rx_buf = val,
+		.is_control_done = true,
+	};
+
+	return qspi_ctrl_exec(base, spi_ss, &qspi_cmd);
+}
+
+/* Read `exp_size` byte of the register continuously, and verify them */
+bool qspi_ctrl_verify_register(uint32_t base, uint32_t spi_ss, uint8_t cmd,
+								size_t exp_size, const uint8_t *exp_val)
+{
+	uint8_t val[QSPI_FIFO_DEPTH];
+	struct qspi_cmd qspi_cmd = {
+		.opcode = cmd,
+		.dir = QSPI_CMD_DIR_RX,
+		.size = exp_size,
+		.rx_buf = val,
+		.is_control_done = true,
+	};
+	bool ret = true;
+
+	if (exp_size > sizeof(val) || !qspi_ctrl_exec(base, spi_ss, &qspi_cmd)) {
+		return false;
+	}
+
+	for (uint8_t i=0; i<exp_size; i++) {
+		if (val[i] != exp_val[i]) {
+			err("  !!! Register (0x%02x) [%d] 0x%02x (exp:0x%02x)\n",
+					cmd, i, val[i], exp_val[i]);
+			ret = false;
+		}
+	}
+
+	return ret;
+}
+
+/* Write Enable (0x06) or Write Disable (0x04), and verify Status Register 1 */
+bool qspi_ctrl_set_write_enable(uint32_t base, uint32_t spi_ss, bool enable)
+{
+	uint8_t exp_status = enable ? QSPI_SR1_WEL : 0x00;
+	uint8_t cmd = enable ? 0x06 : 0x04;
+
+	debug("* Set `Write %s` (Instructure:0x%02x) \n", enable ? "Enable" : "Disable", cmd);
+	if (!qspi_ctrl_send_command(base, spi_ss, cmd)) {
+		assert();
+		return false;
+	}
+
+	if (!qspi_ctrl_verify_status_register1(base, spi_ss, 1, &exp_status)) {
+		assert();
+		return false;
+	}
+
+	return true;
+}
+
+bool qspi_ctrl_verify_status_register1(uint32_t base, uint32_t spi_ss, size_t exp_size,
+										const uint8_t *exp_val)
+{
+	if (!qspi_ctrl_verify_register(base, spi_ss, 0x05, exp_size, exp_val)) {
+		assert();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Write QUAD I/O mode by the register write instruction `cmd` (e.g.
+ * Write Registers), and `val` is sent after the instruction.
+ */
+bool qspi_ctrl_set_quad_io_mode(uint32_t base, uint32_t spi_ss, uint8_t cmd,
+								const uint8_t *val, size_t size)
+{
+	struct qspi_cmd qspi_cmd = {
+		.opcode = cmd,
+		.dir = QSPI_CMD_DIR_TX,
+		.size = size,
+		.tx_data = val,
+		.is_control_done = true,
+	};
+
+	debug("* Set QUAD I/O mode (Instructure:0x%02x, %d byte)\n", cmd, size);
+	if (!qspi_ctrl_exec(base, spi_ss, &qspi_cmd)) {
+		assert();
+		return false;
+	}
+
+	return true;
+}
+
+/* Verify the register read by `cmd` has QUAD I/O mode set */
+bool qspi_ctrl_verify_quad_io_mode(uint32_t base, uint32_t spi_ss, uint8_t cmd,
+									size_t exp_size, const uint8_t *exp_val)
+{
+	if (!qspi_ctrl_verify_register(base, spi_ss, cmd, exp_size, exp_val)) {
+		err("  !!! QUAD I/O mode is not set\n");
+		return false;
+	}
+
+	return true;
+}
+
+bool qspi_ctrl_read_jedec_id(uint32_t base, uint32_t spi_ss, uint8_t *jedec_id)
+{
+	struct qspi_cmd cmd = {
+		.opcode = 0x9F,
+		.dir = QSPI_CMD_DIR_RX,
+		.size = QSPI_JEDEC_ID_BYTE,
+		.rx_buf = jedec_id,
+		.is_control_done = true,
+	};
+
+	return qspi_ctrl_exec(base, spi_ss, &cmd);
+}
+
+/* SFDP reader for qspi_sfdp_discover(), `arg` is struct qspi_ctrl_sfdp_ctx */
+bool qspi_ctrl_read_sfdp(uint32_t addr, uint8_t *buf, size_t size, void *arg)
+{
+	struct qspi_ctrl_sfdp_ctx *ctx = arg;
+	struct qspi_cmd cmd = {
+		.opcode = 0x5A,
+		.addr_byte = QSPI_ADDR_BYTE,
+		.addr = addr,
+		.dummy_byte = QSPI_SFDP_DUMMY_BYTE,
+		.dir = QSPI_CMD_DIR_RX,
+		.size = size,
+		.rx_buf = buf,
+		.is_control_done = true,
+	};
+
+	return qspi_ctrl_exec(ctx->base, ctx->spi_ss, &cmd);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_CTRL_H_
+#define SCOBCA1_FPGA_TEST_QSPI_CTRL_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+#include "qspi_sfdp.h"
+
+#define QSPI_CTRL_SS_NUM (2u)
+#define QSPI_SPI_MODE_QUAD (0x00020000)
+#define QSPI_ADDR_BYTE (3u)
+
+enum QspiCtrlId
+{
+	QSPI_CTRL_CFG,          /* Config Memory 0/1 */
+	QSPI_CTRL_DATA,         /* Data Memory 0/1 */
+	QSPI_CTRL_FRAM,         /* FRAM 0/1 */
+	QSPI_CTRL_NUM,
+};
+
+enum QspiIoWidth
+{
+	QSPI_IO_1_1_1,          /* SINGLE-IO */
+	QSPI_IO_1_1_4,          /* QUAD-IO data */
+	QSPI_IO_1_4_4,          /* QUAD-IO address, mode, dummy and data */
+};
+
+enum QspiCmdDir
+{
+	QSPI_CMD_DIR_NONE,
+	QSPI_CMD_DIR_TX,
+	QSPI_CMD_DIR_RX,
+};
+
+/*
+ * Whole memory command in one SPI SS assertion, run by qspi_ctrl_exec().
+ * `mode_byte` and `dummy_byte` are counted in the byte of the address
+ * width (2 clocks per byte in QUAD-IO).
+ */
+struct qspi_cmd {
+	uint8_t opcode;
+	enum QspiIoWidth io;
+	uint8_t addr_byte;       /* 0 or QSPI_ADDR_BYTE */
+	uint32_t addr;
+	uint8_t mode_byte;       /* Mode (0x00) after the address */
+	uint8_t dummy_byte;
+	enum QspiCmdDir dir;
+	uint32_t size;
+	const uint8_t *tx_data;  /* QSPI_CMD_DIR_TX, `source` if NULL */
+	qspi_write_source_t source;
+	uint8_t *rx_buf;         /* QSPI_CMD_DIR_RX, bounce buffer if NULL */
+	qspi_read_sink_t sink;
+	void *arg;
+	bool is_control_done;    /* Wait for `SPI Control Done` on release */
+};
+
+/* Device specific read of the memories on a QSPI controller */
+struct qspi_mem_ops {
+	bool (*read)(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t *buf,
+					uint32_t size);
+	bool (*read_stream)(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+						qspi_read_sink_t sink, void *arg);
+};
+
+struct qspi_ctrl {
+	const char *name;
+	uint32_t base;
+	uint32_t spi_ss[QSPI_CTRL_SS_NUM];   /* SPI SS of each memory */
+	uint32_t idle_retry;                 /* Access Status polling count */
+	uint32_t spin_retry;                 /* Polling count without sleep */
+	struct k_mutex *lock;                /* Serialize all accesses (recursive) */
+	const struct qspi_mem_ops *ops;
+};
+
+/* Argument of qspi_ctrl_read_sfdp() */
+struct qspi_ctrl_sfdp_ctx {
+	uint32_t base;
+	uint32_t spi_ss;
+};
+
+const struct qspi_ctrl *qspi_ctrl_get(uint32_t base);
+const struct qspi_ctrl *qspi_ctrl_get_by_id(enum QspiCtrlId id);
+void qspi_ctrl_lock(uint32_t base);
+void qspi_ctrl_unlock(uint32_t base);
+bool qspi_ctrl_is_idle(uint32_t base);
+bool qspi_ctrl_activate(uint32_t base, uint32_t spi_mode);
+bool qspi_ctrl_inactivate(uint32_t base);
+bool qspi_ctrl_is_control_done(uint32_t base);
+void qspi_ctrl_write_addr(uint32_t base, uint32_t mem_addr);
+bool qspi_ctrl_send_dummy(uint32_t base, uint8_t dummy_count);
+bool qspi_ctrl_read_and_verify(uint32_t base, size_t exp_size, const uint8_t *exp_val);
+bool qspi_ctrl_exec(uint32_t base, uint32_t spi_ss, const struct qspi_cmd *cmd);
+bool qspi_ctrl_send_command(uint32_t base, uint32_t spi_ss, uint8_t cmd);
+bool qspi_ctrl_read_register(uint32_t base, uint32_t spi_ss, uint8_t cmd, uint8_t *val);
+bool qspi_ctrl_verify_register(uint32_t base, uint32_t spi_ss, uint8_t cmd,
+								size_t exp_size, const uint8_t *exp_val);
+bool qspi_ctrl_set_write_enable(uint32_t base, uint32_t spi_ss, bool enable);
+bool qspi_ctrl_verify_status_register1(uint32_t base, uint32_t spi_ss, size_t exp_size,
+										const uint8_t *exp_val);
+bool qspi_ctrl_set_quad_io_mode(uint32_t base, uint32_t spi_ss, uint8_t cmd,
+								const uint8_t *val, size_t size);
+bool qspi_ctrl_verify_quad_io_mode(uint32_t base, uint32_t spi_ss, uint8_t cmd,
+									size_t exp_size, const uint8_t *exp_val);
+bool qspi_ctrl_read_jedec_id(uint32_t base, uint32_t spi_ss, uint8_t *jedec_id);
+bool qspi_ctrl_read_sfdp(uint32_t addr, uint8_t *buf, size_t size, void *arg);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_CTRL_H_ */
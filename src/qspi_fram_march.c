@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "qspi_fram_march.h"
+#include "qspi_fram_test.h"
+#include "common.h"
+
+#define QSPI_FRAM_MARCH_CHUNK_BYTE (KB(4))
+#define QSPI_FRAM_MARCH_ALIAS_MAX (8u)
+
+enum MarchData
+{
+	MARCH_NONE,
+	MARCH_DATA0,            /* Address of the word */
+	MARCH_DATA1,            /* Inverted address of the word */
+};
+
+struct march_element {
+	const char *name;
+	bool is_descend;
+	enum MarchData read;
+	enum MarchData write;
+};
+
+/* Word errors which may be read from another address */
+struct march_alias {
+	uint32_t alias_bits;            /* Address bits which differ */
+	uint32_t data_bits;             /* Data bits which differ */
+	uint32_t min_addr[2];           /* Lowest failing address by background */
+	uint8_t bg_mask;                /* Backgrounds where it is seen */
+};
+
+struct march_ctx {
+	uint32_t mem_addr;
+	uint32_t mem_size;
+	bool is_inverted;
+	uint32_t err_count;
+	uint32_t fail_addr;
+	uint32_t addr_err_bits;
+	uint32_t data_err_bits;
+	struct march_alias alias[QSPI_FRAM_MARCH_ALIAS_MAX];
+	uint8_t alias_num;
+};
+
+/* March C-: {any(w0); up(r0,w1); up(r1,w0); down(r0,w1); down(r1,w0); any(r0)} */
+static const struct march_element march_c_minus[] = {
+	{"w0",          false, MARCH_NONE,  MARCH_DATA0},
+	{"up(r0,w1)",   false, MARCH_DATA0, MARCH_DATA1},
+	{"up(r1,w0)",   false, MARCH_DATA1, MARCH_DATA0},
+	{"down(r0,w1)", true,  MARCH_DATA0, MARCH_DATA1},
+	{"down(r1,w0)", true,  MARCH_DATA1, MARCH_DATA0},
+	{"r0",          false, MARCH_DATA0, MARCH_NONE},
+};
+
+static uint8_t record_backup[QSPI_FRAM_RECORD_BYTE];
+
+static uint32_t get_march_word(uint32_t mem_addr, bool is_inverted)
+{
+	return is_inverted ? ~mem_addr : mem_addr;
+}
+
+static bool create_march_data(uint8_t *data, size_t size, void *arg)
+{
+	struct march_ctx *ctx = arg;
+	uint32_t word;
+
+	for (uint32_t i=0; i<size; i+=sizeof(word)) {
+		word = get_march_word(ctx->mem_addr + i, ctx->is_inverted);
+		memcpy(&data[i], &word, sizeof(word));
+	}
+	ctx->mem_addr += size;
+
+	return true;
+}
+
+/*
+ * A0/A1 select the byte in the word. When each wrong byte equals another
+ * byte of the expected word, the byte address bits which differ are
+ * returned in `bits`.
+ */
+static bool get_byte_alias_bits(uint32_t word, uint32_t exp, uint32_t *bits)
+{
+	uint8_t val;
+	bool is_found;
+
+	*bits = 0;
+	for (uint8_t i=0; i<sizeof(word); i++) {
+		val = (word >> (i * 8)) & 0xFF;
+		if (val == ((exp >> (i * 8)) & 0xFF)) {
+			continue;
+		}
+
+		is_found = false;
+		for (uint8_t j=0; j<sizeof(exp); j++) {
+			if (val == ((exp >> (j * 8)) & 0xFF)) {
+				*bits |= i ^ j;
+				is_found = true;
+				break;
+			}
+		}
+		if (!is_found) {
+			return false;
+		}
+	}
+
+	return *bits != 0;
+}
+
+/* False is returned when too many different aliases are seen */
+static bool record_march_alias(struct march_ctx *ctx, uint32_t mem_addr, uint32_t alias_bits,
+								uint32_t data_bits)
+{
+	struct march_alias *alias = NULL;
+	uint8_t bg = ctx->is_inverted;
+
+	for (uint8_t i=0; i<ctx->alias_num; i++) {
+		if (ctx->alias[i].alias_bits == alias_bits) {
+			alias = &ctx->alias[i];
+			break;
+		}
+	}
+
+	if (alias == NULL) {
+		if (ctx->alias_num >= QSPI_FRAM_MARCH_ALIAS_MAX) {
+			return false;
+		}
+		alias = &ctx->alias[ctx->alias_num++];
+		alias->alias_bits = alias_bits;
+	}
+
+	if ((alias->bg_mask & BIT(bg)) == 0 || mem_addr < alias->min_addr[bg]) {
+		alias->min_addr[bg] = mem_addr;
+	}
+	alias->bg_mask |= BIT(bg);
+	alias->data_bits |= data_bits;
+
+	return true;
+}
+
+/*
+ * An address fault reads the word of the same other address in both
+ * backgrounds, so its failing addresses are the same. A stuck data bit
+ * looks like an alias too, but fails on the addresses with the opposite
+ * value of the bit in each background. Only the alias seen at the same
+ * lowest address in both backgrounds is taken as an address fault.
+ */
+static void classify_march_alias(struct march_ctx *ctx)
+{
+	struct march_alias *alias;
+
+	for (uint8_t i=0; i<ctx->alias_num; i++) {
+		alias = &ctx->alias[i];
+		if (alias->bg_mask == (BIT(0) | BIT(1)) && alias->min_addr[0] == alias->min_addr[1]) {
+			ctx->addr_err_bits |= alias->alias_bits;
+		} else {
+			ctx->data_err_bits |= alias->data_bits;
+		}
+	}
+}
+
+/*
+ * Verify by word (the RX burst size is a multiple of word). The word of
+ * another address, or the bytes of the word swapped by A0/A1, are
+ * recorded as an alias, and classified by classify_march_alias() after
+ * all elements.
+ */
+static bool verify_march_data(const uint8_t *data, size_t size, void *arg)
+{
+	struct march_ctx *ctx = arg;
+	uint32_t mem_addr;
+	uint32_t word;
+	uint32_t exp;
+	uint32_t alias;
+	uint32_t alias_bits;
+
+	for (uint32_t i=0; i<size; i+=sizeof(word)) {
+		mem_addr = ctx->mem_addr + i;
+		memcpy(&word, &data[i], sizeof(word));
+		exp = get_march_word(mem_addr, ctx->is_inverted);
+		if (word == exp) {
+			continue;
+		}
+
+		if (ctx->err_count++ == 0) {
+			ctx->fail_addr = mem_addr;
+		}
+
+		alias = get_march_word(word, ctx->is_inverted);
+		if (alias < ctx->mem_size && alias % sizeof(word) == 0) {
+			alias_bits = alias ^ mem_addr;
+		} else if (!get_byte_alias_bits(word, exp, &alias_bits)) {
+			alias_bits = 0;
+		}
+
+		if (alias_bits == 0 || !record_march_alias(ctx, mem_addr, alias_bits, word ^ exp)) {
+			ctx->data_err_bits |= word ^ exp;
+		}
+	}
+	ctx->mem_addr += size;
+
+	return true;
+}
+
+static bool march_write(uint8_t mem_no, uint32_t mem_addr, uint32_t size, enum MarchData data,
+						struct march_ctx *ctx)
+{
+	ctx->mem_addr = mem_addr;
+	ctx->is_inverted = data == MARCH_DATA1;
+
+	return qspi_fram_write_stream(mem_no, mem_addr, size, create_march_data, ctx);
+}
+
+static bool march_read(uint8_t mem_no, uint32_t mem_addr, uint32_t size, enum MarchData data,
+						struct march_ctx *ctx)
+{
+	ctx->mem_addr = mem_addr;
+	ctx->is_inverted = data == MARCH_DATA1;
+
+	return qspi_fram_read_stream(mem_no, mem_addr, size, verify_march_data, ctx);
+}
+
+/*
+ * The element with only one operation is a single transfer of the whole
+ * memory, as its address order is `any`. The read and write element is
+ * run word by word in the address order of the element, so a write can
+ * disturb only the words which are read later in the same element.
+ */
+/*
+ * The element with only one operation is a single transfer of the whole
+ * memory, as its address order is `any`. The read and write element is a
+ * reduced march to keep the streaming speed: the address order of the
+ * element is applied to the chunks, and each chunk is read, verified and
+ * written back upward by one command each. So the coupling in the order
+ * of the element is checked only across the chunks.
+ */
+static bool run_march_element(uint8_t mem_no, const struct march_element *element,
+								struct march_ctx *ctx)
+{
+	uint32_t chunk_num = ctx->mem_size / QSPI_FRAM_MARCH_CHUNK_BYTE;
+	uint32_t mem_addr;
+
+	if (element->read == MARCH_NONE) {
+		return march_write(mem_no, 0, ctx->mem_size, element->write, ctx);
+	}
+
+	if (element->write == MARCH_NONE) {
+		return march_read(mem_no, 0, ctx->mem_size, element->read, ctx);
+	}
+
+	for (uint32_t i=0; i<chunk_num; i++) {
+		mem_addr = (element->is_descend ? chunk_num - 1 - i : i) * QSPI_FRAM_MARCH_CHUNK_BYTE;
+		if (!march_read(mem_no, mem_addr, QSPI_FRAM_MARCH_CHUNK_BYTE, element->read, ctx) ||
+				!march_write(mem_no, mem_addr, QSPI_FRAM_MARCH_CHUNK_BYTE, element->write, ctx)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void print_march_fault(uint8_t mem_no, const struct march_ctx *ctx)
+{
+	err("  !!! FRAM %d: %d word error (first:0x%06x)\n", mem_no, ctx->err_count,
+			ctx->fail_addr);
+
+	if (ctx->addr_err_bits != 0) {
+		err("  !!! FRAM %d: Address bit fault 0x%06x\n", mem_no, ctx->addr_err_bits);
+		for (uint8_t bit=0; bit<32; bit++) {
+			if (ctx->addr_err_bits & BIT(bit)) {
+				err("  !!!   A%d\n", bit);
+			}
+		}
+	}
+
+	if (ctx->data_err_bits != 0) {
+		err("  !!! FRAM %d: Data bit fault 0x%08x\n", mem_no, ctx->data_err_bits);
+	}
+}
+
+/*
+ * Run March C- (by chunk) on the whole FRAM with the address in the data.
+ * The record area on FRAM 0 is saved before the test, and restored even
+ * on failure. `err_count` is the number of the word errors.
+ */
+bool qspi_fram_march(uint8_t mem_no, uint32_t *err_count)
+{
+	struct march_ctx ctx = {
+		.mem_size = qspi_fram_get_params(mem_no)->size,
+	};
+	bool is_record = mem_no == QSPI_FRAM_MEM0;
+	uint32_t pass_num = 0;
+	uint32_t start_cycle;
+	bool ret = true;
+
+	*err_count = 0;
+
+	if (ctx.mem_size % QSPI_FRAM_MARCH_CHUNK_BYTE != 0) {
+		err("   Invalid FRAM size (%d byte)\n", ctx.mem_size);
+		return false;
+	}
+
+	if (is_record && !qspi_fram_read(mem_no, QSPI_FRAM_RECORD_ADDR, record_backup,
+										sizeof(record_backup))) {
+		assert();
+		return false;
+	}
+
+	start_cycle = k_cycle_get_32();
+	for (uint8_t i=0; i<ARRAY_SIZE(march_c_minus); i++) {
+		debug("* FRAM %d: March element %s\n", mem_no, march_c_minus[i].name);
+		if (!run_march_element(mem_no, &march_c_minus[i], &ctx)) {
+			assert();
+			ret = false;
+			break;
+		}
+		pass_num += (march_c_minus[i].read != MARCH_NONE) + (march_c_minus[i].write != MARCH_NONE);
+	}
+	qspi_print_throughput("FRAM March C- (by chunk)", ctx.mem_size * pass_num,
+							get_elapsed_us(start_cycle));
+
+	if (is_record && !qspi_fram_write(mem_no, QSPI_FRAM_RECORD_ADDR, record_backup,
+										sizeof(record_backup))) {
+		err("  !!! Failed to restore FRAM record area\n");
+		assert();
+		ret = false;
+	}
+
+	classify_march_alias(&ctx);
+	*err_count = ctx.err_count;
+	if (ctx.err_count != 0) {
+		print_march_fault(mem_no, &ctx);
+		ret = false;
+	}
+
+	return ret;
+}
+
+/*
+ *   1. March C- on FRAM 0 (whole memory, the record area is kept)
+ *   2. March C- on FRAM 1 (whole memory)
+ */
+uint32_t qspi_fram_march_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t err_count;
+
+	info("* [%d] Start QSPI FRAM March Test\n", test_no);
+
+	for (uint8_t i=0; i<QSPI_FRAM_DEV_NUM; i++) {
+		info("* [%d-%d] Start QSPI FRAM [%d]: March C- Test\n", test_no, i + 1, i);
+		if (!qspi_fram_march(i, &err_count)) {
+			assert();
+			err_cnt++;
+		}
+	}
+
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
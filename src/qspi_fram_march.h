@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_FRAM_MARCH_H_
+#define SCOBCA1_FPGA_TEST_QSPI_FRAM_MARCH_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+bool qspi_fram_march(uint8_t mem_no, uint32_t *err_count);
+uint32_t qspi_fram_march_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_FRAM_MARCH_H_ */
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "qspi_fram_mirror.h"
+#include "qspi_fram_test.h"
+#include "common.h"
+
+#define QSPI_FRAM_MIRROR_CHUNK_BYTE (KB(4))
+
+struct mirror_compare_ctx {
+	const uint8_t *ref;
+	uint32_t offset;
+	uint32_t diff_count;
+};
+
+static uint8_t chunk_buf[QSPI_FRAM_MIRROR_CHUNK_BYTE];
+static uint8_t mirror_data[QSPI_FRAM_MIRROR_CHUNK_BYTE];
+
+static bool compare_read_data(const uint8_t *data, size_t size, void *arg)
+{
+	struct mirror_compare_ctx *ctx = arg;
+
+	for (uint32_t i=0; i<size; i++) {
+		if (data[i] != ctx->ref[ctx->offset + i]) {
+			ctx->diff_count++;
+		}
+	}
+	ctx->offset += size;
+
+	return true;
+}
+
+/*
+ * Write the same data to FRAM 0 and 1, by broadcast if the controller
+ * asserts both SPI SS, or one by one otherwise.
+ */
+bool qspi_fram_mirror_write(uint32_t mem_addr, const uint8_t *buf, uint32_t size)
+{
+	uint32_t start_cycle;
+	bool is_broadcast;
+
+	start_cycle = k_cycle_get_32();
+	if (!qspi_fram_broadcast_write(mem_addr, buf, size, &is_broadcast)) {
+		assert();
+		return false;
+	}
+
+	qspi_print_throughput(is_broadcast ? "FRAM mirrored write (broadcast)" :
+							"FRAM mirrored write (sequential)", size,
+							get_elapsed_us(start_cycle));
+
+	return true;
+}
+
+/*
+ * Read FRAM 0 and 1 in turn by chunk and compare them. `diff_count` is
+ * the number of bytes which are different between FRAM 0 and 1.
+ */
+bool qspi_fram_mirror_compare(uint32_t mem_addr, uint32_t size, uint32_t *diff_count)
+{
+	struct mirror_compare_ctx compare;
+	uint32_t chunk;
+
+	*diff_count = 0;
+
+	for (uint32_t offset=0; offset<size; offset+=chunk) {
+		chunk = MIN(size - offset, sizeof(chunk_buf));
+
+		if (!qspi_fram_read(QSPI_FRAM_MEM0, mem_addr + offset, chunk_buf, chunk)) {
+			assert();
+			return false;
+		}
+
+		compare.ref = chunk_buf;
+		compare.offset = 0;
+		compare.diff_count = 0;
+		if (!qspi_fram_read_stream(QSPI_FRAM_MEM1, mem_addr + offset, chunk,
+									compare_read_data, &compare)) {
+			assert();
+			return false;
+		}
+
+		if (compare.diff_count != 0) {
+			err("  !!! FRAM 0x%06x-0x%06x: %d byte is different\n",
+					mem_addr + offset, mem_addr + offset + chunk - 1, compare.diff_count);
+			*diff_count += compare.diff_count;
+		}
+	}
+
+	return *diff_count == 0;
+}
+
+/*
+ *   1. Write FRAM 0 and 1 in turn (4KB) as the reference
+ *   2. Mirrored Write to FRAM 0/1 (4KB)
+ *   3. Compare FRAM 0/1
+ *   4. Verify FRAM 0 with the written data
+ */
+uint32_t qspi_fram_mirror_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t mem_addr = 0x010000;
+	uint32_t size = sizeof(mirror_data);
+	uint32_t start_cycle;
+	uint32_t diff_count;
+
+	info("* [%d] Start QSPI FRAM Mirrored Write Test\n", test_no);
+
+	info("* [%d-1] Start QSPI FRAM [0/1]: Sequential Write Test\n", test_no);
+	qspi_create_fifo_data(0x00, mirror_data, size, false);
+	start_cycle = k_cycle_get_32();
+	for (uint8_t i=0; i<QSPI_FRAM_DEV_NUM; i++) {
+		if (!qspi_fram_write(i, mem_addr, mirror_data, size)) {
+			assert();
+			err_cnt++;
+			goto end_of_test;
+		}
+	}
+	qspi_print_throughput("FRAM sequential write", size, get_elapsed_us(start_cycle));
+
+	info("* [%d-2] Start QSPI FRAM [0/1]: Mirrored Write Test\n", test_no);
+	qspi_create_fifo_data(0x80, mirror_data, size, false);
+	if (!qspi_fram_mirror_write(mem_addr, mirror_data, size)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-3] Start QSPI FRAM [0/1]: Mirrored Compare Test\n", test_no);
+	if (!qspi_fram_mirror_compare(mem_addr, size, &diff_count)) {
+		err("  !!! %d byte is different\n", diff_count);
+		assert();
+		err_cnt++;
+	}
+
+	info("* [%d-4] Start QSPI FRAM [0]: Verify written data\n", test_no);
+	if (!qspi_fram_read(QSPI_FRAM_MEM0, mem_addr, chunk_buf, size)) {
+		assert();
+		err_cnt++;
+	} else if (memcmp(chunk_buf, mirror_data, size) != 0) {
+		err("  !!! Read data mismatch\n");
+		assert();
+		err_cnt++;
+	}
+
+end_of_test:
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_FRAM_MIRROR_H_
+#define SCOBCA1_FPGA_TEST_QSPI_FRAM_MIRROR_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+bool qspi_fram_mirror_write(uint32_t mem_addr, const uint8_t *buf, uint32_t size);
+bool qspi_fram_mirror_compare(uint32_t mem_addr, uint32_t size, uint32_t *diff_count);
+uint32_t qspi_fram_mirror_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_FRAM_MIRROR_H_ */
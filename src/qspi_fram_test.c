@@ -4,530 +4,577 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <zephyr/sys/crc.h>
 #include "qspi_common.h"
+#include "qspi_ctrl.h"
+#include "qspi_fram_test.h"
+#include "qspi_sfdp.h"
 #include "common.h"
 
+#define QSPI_FRAM_BASE (SCOBCA1_FPGA_FRAM_BASE_ADDR)
 #define QSPI_FRAM_MEM_ADDR_SIZE (3u)
-#define QSPI_FRAM_MEM0 (0u)
-#define QSPI_FRAM_MEM1 (1u)
-#define QSPI_FRAM_MEM0_SS (0x01)
-#define QSPI_FRAM_MEM1_SS (0x02)
-#define QSPI_ASR_IDLE (0x00)
-#define QSPI_ASR_BUSY (0x01)
 #define QSPI_FIFO_MAX_BYTE (16u)
-#define QSPI_NOR_FLASH_DUMMY_CYCLE_COUNT (2u)
-#define QSPI_SPI_MODE_QUAD   (0x00020000)
+#define QSPI_QUAD_CLOCKS_PER_BYTE (2u)
+#define QSPI_FRAM_DUMMY_CYCLE_COUNT (2u)
 
-static bool is_qspi_idle(void)
+/*
+ * 4Mbit FRAM parameters, used when SFDP is not available. The read
+ * latency is always the one set to Configuration Register on initialize.
+ */
+static const struct qspi_mem_params fram_default_params = {
+	.size = 512 * 1024,
+	.page_size = 0,
+	.read_mode = QSPI_READ_MODE_1_4_4,
+	.read_opcode = 0xEB,
+	.read_mode_clocks = 2,
+	.read_dummy_clocks = QSPI_FRAM_DUMMY_CYCLE_COUNT * QSPI_QUAD_CLOCKS_PER_BYTE,
+	.quad_enable = QSPI_QE_NONE,
+};
+
+static struct qspi_mem_params fram_params[QSPI_FRAM_DEV_NUM];
+static bool is_fram_params_valid[QSPI_FRAM_DEV_NUM];
+
+static bool qspi_fram_set_quad_read_mode(uint32_t spi_ss)
 {
-	debug("* Confirm QSPI Access Status is `Idle`\n");
-	if (!assert32(SCOBCA1_FPGA_FRAM_QSPI_ASR, QSPI_ASR_IDLE,
-			REG_READ_RETRY(10))) {
-		err("QSPI (FRAM) is busy, so exit test\n");
+	/* Active SPI SS with SINGLE-IO */
+	if (!qspi_ctrl_activate(QSPI_FRAM_BASE, spi_ss)) {
 		return false;
 	}
 
-	return true;
-}
-
-static bool activate_spi_ss(uint32_t spi_mode)
-{
-	debug("* Activate SPI SS with %08x\n", spi_mode);
-	write32(SCOBCA1_FPGA_FRAM_QSPI_ACR, spi_mode);
-	if (!is_qspi_idle()) {
+	debug("* Set QUAD-IO read mode\n");
+	write32(SCOBCA1_FPGA_QSPI_TDR(QSPI_FRAM_BASE), 0xEB);
+	if (!qspi_ctrl_is_idle(QSPI_FRAM_BASE)) {
+		assert();
 		return false;
 	}
 
+	/* Keep SPI SS for Quad Read */
+
 	return true;
 }
 
-static bool inactivate_spi_ss(void)
+static bool qspi_fram_quad_read_data(uint32_t spi_ss, uint8_t read_size, const uint8_t *exp_vals, uint32_t mem_addr)
 {
-	debug("* Inactivate SPI SS\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_ACR, 0x00000000);
-	if (!is_qspi_idle()) {
+	bool ret;
+
+	debug("* Activate SPI SS with Quad-IO SPI Mode\n");
+	write32(SCOBCA1_FPGA_QSPI_ACR(QSPI_FRAM_BASE), QSPI_SPI_MODE_QUAD + spi_ss);
+
+	debug("* Send Memory Address (3byte)\n");
+	qspi_ctrl_write_addr(QSPI_FRAM_BASE, mem_addr);
+	
+	debug("* Send Mode (0x00)\n");
+	write32(SCOBCA1_FPGA_QSPI_TDR(QSPI_FRAM_BASE), 0x00);
+
+	/* Send Dummy Cycle */
+	qspi_ctrl_send_dummy(QSPI_FRAM_BASE, QSPI_FRAM_DUMMY_CYCLE_COUNT);
+	if (!qspi_ctrl_is_idle(QSPI_FRAM_BASE)) {
+		assert();
 		return false;
 	}
 
-	return true;
-}
+	/* Read RX data and Verify */
+	ret = qspi_ctrl_read_and_verify(QSPI_FRAM_BASE, read_size, exp_vals);
+	if (!ret) {
+		assert();
+	}
 
-static void write_data_to_flash(uint32_t *write_data, size_t size)
-{
-	debug("* Write TX FIFO %d byte\n", size);
-	for (uint8_t i=0; i<size; i++) {
-		write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, write_data[i]);
+	/* Inactive SPI SS */
+	if (!qspi_ctrl_inactivate(QSPI_FRAM_BASE)) {
+		assert();
+		return false;
 	}
+
+	return ret;
 }
 
-static void write_mem_addr_to_flash(uint32_t mem_addr)
+/*
+ * Read the whole range by a single Quad I/O Read command. FRAM has no
+ * page boundary on read, so the address, the mode and the dummy cycle
+ * are sent only once.
+ */
+static bool qspi_fram_quad_read_stream(uint32_t spi_ss, uint32_t mem_addr, uint32_t size,
+										uint8_t *buf, qspi_read_sink_t sink, void *arg)
 {
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, (mem_addr & 0x00FF0000) >> 16);
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, (mem_addr & 0x0000FF00) >> 8);
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, (mem_addr & 0x000000FF));
+	struct qspi_cmd cmd = {
+		.opcode = 0xEB,
+		.io = QSPI_IO_1_4_4,
+		.addr_byte = QSPI_ADDR_BYTE,
+		.addr = mem_addr,
+		.mode_byte = 1,
+		.dummy_byte = QSPI_FRAM_DUMMY_CYCLE_COUNT,
+		.dir = QSPI_CMD_DIR_RX,
+		.size = size,
+		.rx_buf = buf,
+		.sink = sink,
+		.arg = arg,
+	};
+	bool ret;
+
+	qspi_ctrl_lock(QSPI_FRAM_BASE);
+	ret = qspi_ctrl_exec(QSPI_FRAM_BASE, spi_ss, &cmd);
+	qspi_ctrl_unlock(QSPI_FRAM_BASE);
+
+	return ret;
 }
 
-static bool send_dummy_cycle(uint8_t dummy_count)
+static bool discover_fram_params(uint32_t spi_ss, uint8_t mem_no)
 {
-	debug("* Send dummy cycle %d byte\n", dummy_count);
-	for (uint8_t i=0; i<dummy_count; i++) {
-		write32(SCOBCA1_FPGA_FRAM_QSPI_RDR, 0x00);
-	}
+	struct qspi_mem_params *params = &fram_params[mem_no];
+	struct qspi_ctrl_sfdp_ctx ctx = {
+		.base = QSPI_FRAM_BASE,
+		.spi_ss = spi_ss,
+	};
 
-	if (!is_qspi_idle()) {
-		assert();
+	*params = fram_default_params;
+	is_fram_params_valid[mem_no] = false;
+
+	if (!qspi_ctrl_read_jedec_id(QSPI_FRAM_BASE, spi_ss, params->jedec_id)) {
 		return false;
 	}
 
-	debug("* Discard dummy data\n");
-	for (uint8_t i=0; i<dummy_count; i++) {
-		sys_read32(SCOBCA1_FPGA_FRAM_QSPI_RDR);
+	if (!qspi_sfdp_discover(qspi_ctrl_read_sfdp, &ctx, params)) {
+		debug("* FRAM [%d] has no SFDP, use the default parameters\n", mem_no);
 	}
 
+	/* Keep the read latency set to Configuration Register */
+	params->read_mode = fram_default_params.read_mode;
+	params->read_opcode = fram_default_params.read_opcode;
+	params->read_mode_clocks = fram_default_params.read_mode_clocks;
+	params->read_dummy_clocks = fram_default_params.read_dummy_clocks;
+	is_fram_params_valid[mem_no] = true;
+
 	return true;
 }
 
-static bool read_and_verify_rx_data(size_t exp_size, uint32_t *exp_val)
+const struct qspi_mem_params *qspi_fram_get_params(uint8_t mem_no)
 {
-	bool ret = true;
-
-	debug("* Reqest RX FIFO %d byte\n", exp_size);
-	for (uint8_t i=0; i<exp_size; i++) {
-		write32(SCOBCA1_FPGA_FRAM_QSPI_RDR, 0x00);
+	if (mem_no >= QSPI_FRAM_DEV_NUM || !is_fram_params_valid[mem_no]) {
+		return &fram_default_params;
 	}
 
-	if (!is_qspi_idle()) {
-		return false;
-	}
+	return &fram_params[mem_no];
+}
 
-	debug("* Read RX FIFO %d byte and verify the value\n", exp_size);
-	for (uint8_t i=0; i<exp_size; i++) {
-		if (!assert32(SCOBCA1_FPGA_FRAM_QSPI_RDR, exp_val[i],
-						REG_READ_RETRY(0))) {
-			ret = false;
-		}
+static bool get_fram_spi_ss(uint8_t mem_no, uint32_t *spi_ss)
+{
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+		return false;
 	}
+	*spi_ss = qspi_ctrl_get(QSPI_FRAM_BASE)->spi_ss[mem_no];
 
-	return ret;
+	return true;
 }
 
-static bool is_qspi_control_done(void)
+static bool is_valid_fram_range(uint8_t mem_no, uint32_t mem_addr, uint32_t size)
 {
-	debug("* Confirm QSPI Interrupt Stauts is `SPI Control Done`\n");
-	if (!assert32(SCOBCA1_FPGA_FRAM_QSPI_ISR, 0x01, REG_READ_RETRY(10))) {
-		return false;
-	}
+	uint32_t mem_size = qspi_fram_get_params(mem_no)->size;
 
-	debug("* Clear QSPI Interrupt Stauts\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_ISR, 0x01);
-	if (!assert32(SCOBCA1_FPGA_FRAM_QSPI_ISR, 0x00, REG_READ_RETRY(10))) {
+	if (mem_addr > mem_size || size > mem_size - mem_addr) {
+		err("   Invalid FRAM range (0x%08x, %d byte)\n", mem_addr, size);
 		return false;
 	}
 
 	return true;
 }
 
-static bool verify_status_resisger1(uint32_t spi_ss, size_t exp_size, uint32_t *exp_val)
+static bool qspi_fram_init(uint8_t mem_no)
 {
-	bool ret;
+	uint32_t spi_ss;
+	/* Write Any Register (0x71) to address 0x000002 */
+	uint8_t qe_val[] = {0x00, 0x00, 0x02, 0x42};
+	uint8_t exp_quad_mode[] = {0x42};
 
-	/* Activate SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(spi_ss)) {
-		assert();
+	if (!get_fram_spi_ss(mem_no, &spi_ss)) {
 		return false;
 	}
 
-	debug("* Request Status Register 1\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x05);
-	if (!is_qspi_idle()) {
+	debug("* [#0] Discover JEDEC ID and SFDP\n");
+	if (!discover_fram_params(spi_ss, mem_no)) {
 		assert();
 		return false;
 	}
 
-	/* Read Memory data (1byte) adn Verify */
-	ret = read_and_verify_rx_data(exp_size, exp_val);
-	if (!ret) {
+	debug("* [#1] Set to `Write Enable'\n");
+	if (!qspi_ctrl_set_write_enable(QSPI_FRAM_BASE, spi_ss, true)) {
 		assert();
+		return false;
 	}
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss()) {
+	debug("* [#2] Set to `QUAD I/O modee'\n");
+	if (!qspi_ctrl_set_quad_io_mode(QSPI_FRAM_BASE, spi_ss, 0x71, qe_val, ARRAY_SIZE(qe_val))) {
 		assert();
 		return false;
 	}
 
-	/* Confirm SPI Control is Done */
-	if (!is_qspi_control_done()) {
+	/* FRAM has no write cycle time, so the register is updated at once */
+	debug("* [#3] Verify Configuration Register is QUAD I/O mode (0x02)\n");
+	if (!qspi_ctrl_verify_quad_io_mode(QSPI_FRAM_BASE, spi_ss, 0x35, ARRAY_SIZE(exp_quad_mode),
+										exp_quad_mode)) {
 		assert();
 		return false;
 	}
 
-	return ret;
+	return true;
 }
 
-static bool set_write_enable(uint32_t spi_ss, bool enable)
+static bool crc_read_data(const uint8_t *data, size_t size, void *arg)
 {
-	uint32_t exp_write_disable[] = {0x00};
-	uint32_t exp_write_enable[] = {0x02};
+	uint32_t *crc = arg;
 
-	/* Active SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(spi_ss)) {
-		assert();
-		return false;
-	}
+	*crc = crc32_ieee_update(*crc, data, size);
 
-	if (enable) {
-		debug("* Set `Write Enable` (Instructure:0x06) \n");
-		write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x06);
-	} else {
-		debug("* Set `Write Disable` (Instructure:0x04) \n");
-		write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x04);
-	}
+	return true;
+}
 
-	if (!is_qspi_idle()) {
-		assert();
-		return false;
-	}
+/*
+ * Write the whole range by a single Quad I/O Write command. FRAM has no
+ * page boundary and no write cycle time, so only one Write Enable is
+ * needed, and the Write Enable Latch is reset at the end of the command.
+ * The data is taken from `buf`, or from `source` without `buf`.
+ */
+static bool fram_quad_write_stream(uint32_t spi_ss, uint32_t mem_addr, uint32_t size,
+									const uint8_t *buf, qspi_write_source_t source, void *arg)
+{
+	struct qspi_cmd cmd = {
+		.opcode = 0xD2,
+		.io = QSPI_IO_1_4_4,
+		.addr_byte = QSPI_ADDR_BYTE,
+		.addr = mem_addr,
+		.mode_byte = 1,
+		.dir = QSPI_CMD_DIR_TX,
+		.size = size,
+		.tx_data = buf,
+		.source = source,
+		.arg = arg,
+	};
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss()) {
+	if (!qspi_ctrl_set_write_enable(QSPI_FRAM_BASE, spi_ss, true)) {
 		assert();
 		return false;
 	}
 
-	/* Confirm SPI Control is Done */
-	if (!is_qspi_control_done()) {
+	if (!qspi_ctrl_exec(QSPI_FRAM_BASE, spi_ss, &cmd)) {
 		assert();
 		return false;
 	}
 
-	if (enable) {
-		if (!verify_status_resisger1(spi_ss, ARRAY_SIZE(exp_write_enable), exp_write_enable)) {
-			assert();
-			return false;
-		}
-	} else {
-		if (!verify_status_resisger1(spi_ss, ARRAY_SIZE(exp_write_disable), exp_write_disable)) {
-			assert();
-			return false;
-		}
-	}
-
 	return true;
 }
 
-static bool set_quad_io_mode(uint32_t spi_ss)
+static bool qspi_fram_quad_write_stream(uint32_t spi_ss, uint32_t mem_addr, uint32_t size,
+										const uint8_t *buf, qspi_write_source_t source,
+										void *arg)
 {
-	/* Activate SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(spi_ss)) {
-		assert();
-		return false;
-	}
+	bool ret;
 
-	debug("* Set QUAD I/O mode and dummy cycle (4) to configuration register\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x71);
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x00);
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x00);
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x02);
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x42);
-	if (!is_qspi_idle()) {
-		assert();
-		return false;
-	}
+	qspi_ctrl_lock(QSPI_FRAM_BASE);
+	ret = fram_quad_write_stream(spi_ss, mem_addr, size, buf, source, arg);
+	qspi_ctrl_unlock(QSPI_FRAM_BASE);
 
-	/* Inactivate SPI SS */
-	if (!inactivate_spi_ss()) {
-		return false;
-	}
+	return ret;
+}
 
-	/* Confirm SPI Control is Done */
-	if(!is_qspi_control_done()) {
-		assert();
-		return false;
-	}
+/* Fill TX data created by qspi_create_fifo_data() */
+static bool create_write_data(uint8_t *data, size_t size, void *arg)
+{
+	uint8_t *start_val = arg;
+
+	*start_val = qspi_create_fifo_data(*start_val, data, size, false);
 
 	return true;
 }
 
-static bool verify_config_register(uint32_t spi_ss, size_t exp_size, uint32_t *exp_val)
+bool qspi_fram_multi_write(uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val)
 {
 	bool ret;
+	uint32_t spi_ss;
+	uint32_t start_cycle;
 
-	/* Activate SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(spi_ss)) {
-		assert();
-		return false;
-	}
-
-	debug("* Request Configuration Register\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x35);
-	if (!is_qspi_idle()) {
-		assert();
-		return false;
-	}
-
-	/* Read Memory data (1byte) adn Verify */
-	ret = read_and_verify_rx_data(exp_size, exp_val);
-	if (!ret) {
-		assert();
-	}
-
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss()) {
-		assert();
+	if (!get_fram_spi_ss(mem_no, &spi_ss) || !is_valid_fram_range(mem_no, mem_addr, size)) {
 		return false;
 	}
 
-	/* Confirm SPI Control is Done */
-	if (!is_qspi_control_done()) {
-		assert();
-		return false;
-	}
+	debug("* [#1] Write Data (QUAD-IO Mode, continuous)\n");
+	start_cycle = k_cycle_get_32();
+	ret = qspi_fram_quad_write_stream(spi_ss, mem_addr, size, NULL, create_write_data,
+										&start_val);
+	qspi_print_throughput("FRAM write", size, get_elapsed_us(start_cycle));
 
 	return ret;
 }
 
-static bool verify_quad_io_mode(uint32_t spi_ss)
+static bool is_write_enabled(uint32_t spi_ss, bool *is_enabled)
 {
-	uint32_t exp_quad_mode[] = {0x42};
+	uint8_t status;
 
-	if (!verify_config_register(spi_ss, ARRAY_SIZE(exp_quad_mode), exp_quad_mode)) {
+	if (!qspi_ctrl_read_register(QSPI_FRAM_BASE, spi_ss, 0x05, &status)) {
 		assert();
 		return false;
 	}
+	*is_enabled = (status & 0x02) != 0;
 
 	return true;
 }
 
-static bool qspi_fram_init(uint8_t mem_no)
+static bool write_fram_in_turn(uint32_t mem_addr, const uint8_t *buf, uint32_t size)
 {
-	uint32_t spi_ss;
-
-	if (mem_no > 1) {
-		debug("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
-		return false;
+	for (uint8_t i=0; i<QSPI_FRAM_DEV_NUM; i++) {
+		if (!qspi_fram_write(i, mem_addr, buf, size)) {
+			return false;
+		}
 	}
 
-	if (mem_no == QSPI_FRAM_MEM0) {
-		spi_ss = QSPI_FRAM_MEM0_SS;
-	} else {
-		spi_ss = QSPI_FRAM_MEM1_SS;
-	}
+	return true;
+}
 
-	debug("* [#1] Set to `Write Enable'\n");
-	if (!set_write_enable(spi_ss, true)) {
-		assert();
-		return false;
+/*
+ * Write the same data to FRAM 0 and 1 by one Quad I/O Write with both
+ * SPI SS asserted. Only the commands without read data are sent to both
+ * memories. Write Enable Latch is cleared and then read from each memory
+ * to confirm that the controller asserted both SPI SS. Otherwise the
+ * memories are written one by one. `is_broadcast` is set when both are
+ * written at once. The written data is compared by
+ * qspi_fram_mirror_compare(), out of the write time.
+ */
+static bool fram_broadcast_write(uint32_t mem_addr, const uint8_t *buf, uint32_t size,
+								bool *is_broadcast)
+{
+	const struct qspi_ctrl *ctrl = qspi_ctrl_get(QSPI_FRAM_BASE);
+	uint32_t spi_ss = 0;
+	bool is_enabled = true;
+	bool is_mem_enabled;
+	struct qspi_cmd cmd = {
+		.opcode = 0xD2,
+		.io = QSPI_IO_1_4_4,
+		.addr_byte = QSPI_ADDR_BYTE,
+		.addr = mem_addr,
+		.mode_byte = 1,
+		.dir = QSPI_CMD_DIR_TX,
+		.size = size,
+		.tx_data = buf,
+	};
+
+	*is_broadcast = false;
+
+	for (uint8_t i=0; i<QSPI_FRAM_DEV_NUM; i++) {
+		if (!is_valid_fram_range(i, mem_addr, size)) {
+			return false;
+		}
+		spi_ss |= ctrl->spi_ss[i];
 	}
 
-	debug("* [#2] Set to `QUAD I/O modee'\n");
-	if (!set_quad_io_mode(spi_ss)) {
-		assert();
-		return false;
+	debug("* Set `Write Disable` to each FRAM\n");
+	for (uint8_t i=0; i<QSPI_FRAM_DEV_NUM; i++) {
+		if (!qspi_ctrl_send_command(QSPI_FRAM_BASE, ctrl->spi_ss[i], 0x04) ||
+			!is_write_enabled(ctrl->spi_ss[i], &is_mem_enabled)) {
+			assert();
+			return false;
+		}
+		if (is_mem_enabled) {
+			err("  !!! FRAM [%d] Write Enable Latch is not cleared\n", i);
+			return false;
+		}
 	}
 
-	/* Wait 1 sec */
-	k_sleep(K_MSEC(1000));
-
-	debug("* [#3] Verify Configuration Register is QUAD I/O mode (0x02)\n");
-	if (!verify_quad_io_mode(spi_ss)) {
+	debug("* Set `Write Enable` to all FRAM (SPI SS:0x%02x)\n", spi_ss);
+	if (!qspi_ctrl_send_command(QSPI_FRAM_BASE, spi_ss, 0x06)) {
 		assert();
 		return false;
 	}
 
-	return true;
-}
+	for (uint8_t i=0; i<QSPI_FRAM_DEV_NUM; i++) {
+		if (!is_write_enabled(ctrl->spi_ss[i], &is_mem_enabled)) {
+			return false;
+		}
+		is_enabled &= is_mem_enabled;
+	}
 
-static bool qspi_fram_set_quad_read_mode(uint32_t spi_ss)
-{
-	/* Active SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(spi_ss)) {
-		return false;
+	if (!is_enabled) {
+		info("* FRAM broadcast write is not supported, write FRAM 0/1 in turn\n");
+		return write_fram_in_turn(mem_addr, buf, size);
 	}
 
-	debug("* Set QUAD-IO read mode\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0xEB);
-	if (!is_qspi_idle()) {
+	if (!qspi_ctrl_exec(QSPI_FRAM_BASE, spi_ss, &cmd)) {
 		assert();
 		return false;
 	}
-
-	/* Keep SPI SS for Quad Read */
+	*is_broadcast = true;
 
 	return true;
 }
 
-static bool qspi_fram_quad_read_data(uint32_t spi_ss, uint8_t read_size, uint32_t *exp_vals, uint32_t mem_addr)
+bool qspi_fram_broadcast_write(uint32_t mem_addr, const uint8_t *buf, uint32_t size,
+								bool *is_broadcast)
 {
 	bool ret;
 
-	debug("* Activate SPI SS with Quad-IO SPI Mode\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_ACR, QSPI_SPI_MODE_QUAD + spi_ss);
+	qspi_ctrl_lock(QSPI_FRAM_BASE);
+	ret = fram_broadcast_write(mem_addr, buf, size, is_broadcast);
+	qspi_ctrl_unlock(QSPI_FRAM_BASE);
 
-	debug("* Send Memory Address (3byte)\n");
-	write_mem_addr_to_flash(mem_addr);
-	
-	debug("* Send Mode (0x00)\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x00);
-
-	/* Send Dummy Cycle */
-	send_dummy_cycle(QSPI_NOR_FLASH_DUMMY_CYCLE_COUNT);
-	if (!is_qspi_idle()) {
-		assert();
-		return false;
-	}
+	return ret;
+}
 
-	/* Read RX data and Verify */
-	ret = read_and_verify_rx_data(read_size, exp_vals);
-	if (!ret) {
-		assert();
-	}
+/* Write `size` byte from `buf` by continuous Quad I/O Write */
+bool qspi_fram_write(uint8_t mem_no, uint32_t mem_addr, const uint8_t *buf, uint32_t size)
+{
+	uint32_t spi_ss;
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss()) {
-		assert();
+	if (!get_fram_spi_ss(mem_no, &spi_ss) || !is_valid_fram_range(mem_no, mem_addr, size)) {
 		return false;
 	}
 
-	return ret;
+	return qspi_fram_quad_write_stream(spi_ss, mem_addr, size, buf, NULL, NULL);
 }
 
-static bool qspi_fram_quad_write_data(uint32_t spi_ss, uint8_t write_size, uint32_t *write_data, uint32_t mem_addr)
+/*
+ * Write `size` byte by continuous Quad I/O Write, and take the write
+ * data from `source` for each TX FIFO burst.
+ */
+bool qspi_fram_write_stream(uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+							qspi_write_source_t source, void *arg)
 {
-	if (!activate_spi_ss(spi_ss) ) {
-		return false;
-	}
+	uint32_t spi_ss;
 
-	debug("* Snd QUAD I/O Write instruction\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0xD2);
-	if (!is_qspi_idle()) {
-		assert();
+	if (!get_fram_spi_ss(mem_no, &spi_ss) || !is_valid_fram_range(mem_no, mem_addr, size)) {
 		return false;
 	}
 
-	debug("* Activate SPI SS with Quad-IO SPI Mode\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_ACR, QSPI_SPI_MODE_QUAD + spi_ss);
+	return qspi_fram_quad_write_stream(spi_ss, mem_addr, size, NULL, source, arg);
+}
 
-	debug("* Send Memory Address (3byte)\n");
-	write_mem_addr_to_flash(mem_addr);
+static bool qspi_fram_multi_read_verify(uint32_t spi_ss, uint32_t mem_addr, uint32_t size,
+										uint8_t start_val)
+{
+	bool ret = true;
+	uint8_t exp_vals[QSPI_FIFO_MAX_BYTE];
+	uint16_t loop_count;
 
-	debug("* Send Mode (0x00)\n");
-	write32(SCOBCA1_FPGA_FRAM_QSPI_TDR, 0x00);
+	loop_count = size/QSPI_FIFO_MAX_BYTE;
+	for (uint16_t i=0; i<loop_count; i++) {
+		qspi_ctrl_lock(QSPI_FRAM_BASE);
 
-	if (!is_qspi_idle()) {
-		assert();
-		return false;
-	}
+		debug("* [#1] Set QUAD-IO Read Mode\n");
+		if (!qspi_fram_set_quad_read_mode(spi_ss)) {
+			assert();
+			ret = false;
+		}
 
-	/* Write data */
-	write_data_to_flash(write_data, write_size);
-	if (!is_qspi_idle()) {
-		assert();
-		return false;
-	}
+		debug("* [#2] Read Data (QUAD-IO Mode) \n");
+		start_val = qspi_create_fifo_data(start_val, exp_vals, QSPI_FIFO_MAX_BYTE, false);
+		if (!qspi_fram_quad_read_data(spi_ss, QSPI_FIFO_MAX_BYTE, exp_vals, mem_addr)) {
+			ret = false;
+		}
+		mem_addr += QSPI_FIFO_MAX_BYTE;
 
-	if (!inactivate_spi_ss() ) {
-		assert();
-		return false;
+		qspi_ctrl_unlock(QSPI_FRAM_BASE);
 	}
 
-	return true;
+	return ret;
 }
 
-bool qspi_fram_multi_write(uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val)
+/* Read `size` byte into `buf` directly from RX FIFO */
+bool qspi_fram_read(uint8_t mem_no, uint32_t mem_addr, uint8_t *buf, uint32_t size)
 {
 	uint32_t spi_ss;
-	uint32_t write_data[QSPI_FIFO_MAX_BYTE];
-	uint16_t loop_count;
 
-	if (mem_no > 1) {
-		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+	if (!get_fram_spi_ss(mem_no, &spi_ss) || !is_valid_fram_range(mem_no, mem_addr, size)) {
 		return false;
 	}
 
-	if (mem_no == QSPI_FRAM_MEM0) {
-		spi_ss = QSPI_FRAM_MEM0_SS;
-	} else {
-		spi_ss = QSPI_FRAM_MEM1_SS;
-	}
-
-	loop_count = size/QSPI_FIFO_MAX_BYTE;
-	for (uint16_t i=0; i<loop_count; i++) {
-
-		debug("* [#1] Set to `Write Enable'\n");
-		if (!set_write_enable(spi_ss, true)) {
-			assert();
-			return false;
-		}
+	return qspi_fram_quad_read_stream(spi_ss, mem_addr, size, buf, NULL, NULL);
+}
 
-		debug("* [#2] Write Data (QUAD Mode)\n");
-		start_val = qspi_create_fifo_data(start_val, write_data, QSPI_FIFO_MAX_BYTE, false);
-		if (!qspi_fram_quad_write_data(spi_ss, QSPI_FIFO_MAX_BYTE, write_data, mem_addr)) {
-			assert();
-			return false;
-		}
+/*
+ * Read `size` byte by continuous Quad I/O Read, and hand the read data
+ * to `sink` for each RX FIFO burst.
+ */
+bool qspi_fram_read_stream(uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+							qspi_read_sink_t sink, void *arg)
+{
+	uint32_t spi_ss;
 
-		debug("* [#3] Set to `Write Disable'\n");
-		if (!set_write_enable(spi_ss, false)) {
-			assert();
-			return false;
-		}
-		mem_addr += QSPI_FIFO_MAX_BYTE;
+	if (!get_fram_spi_ss(mem_no, &spi_ss) || !is_valid_fram_range(mem_no, mem_addr, size)) {
+		return false;
 	}
 
-	return true;
+	return qspi_fram_quad_read_stream(spi_ss, mem_addr, size, NULL, sink, arg);
 }
 
 bool qspi_fram_multi_read(uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val)
 {
-	bool ret = true;
+	bool ret;
 	uint32_t spi_ss;
-	uint32_t exp_vals[QSPI_FIFO_MAX_BYTE];
-	uint16_t loop_count;
+	uint32_t crc = 0;
+	uint32_t exp_crc;
+	uint32_t start_cycle;
 
-	if (mem_no > 1) {
-		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+	if (!get_fram_spi_ss(mem_no, &spi_ss)) {
 		return false;
 	}
 
-	if (mem_no == QSPI_FRAM_MEM0) {
-		spi_ss = QSPI_FRAM_MEM0_SS;
-	} else {
-		spi_ss = QSPI_FRAM_MEM1_SS;
+	exp_crc = qspi_create_fifo_data_crc(start_val, size, false);
+
+	debug("* [#1] Read Data (QUAD-IO Mode, continuous) and calculate CRC\n");
+	start_cycle = k_cycle_get_32();
+	ret = qspi_fram_quad_read_stream(spi_ss, mem_addr, size, NULL, crc_read_data, &crc);
+	qspi_print_throughput("FRAM read", size, get_elapsed_us(start_cycle));
+
+	if (ret && crc == exp_crc) {
+		return true;
 	}
 
-	loop_count = size/QSPI_FIFO_MAX_BYTE;
-	for (uint16_t i=0; i<loop_count; i++) {
+	err("  !!! CRC mismatch 0x%08x (exp:0x%08x), verify each byte\n", crc, exp_crc);
+	qspi_fram_multi_read_verify(spi_ss, mem_addr, size, start_val);
+	assert();
 
-		debug("* [#1] Set QUAD-IO Read Mode\n");
-		if (!qspi_fram_set_quad_read_mode(spi_ss)) {
-			assert();
-			ret = false;
-		}
+	return false;
+}
 
-		debug("* [#2] Read Data (QUAD-IO Mode) \n");
-		start_val = qspi_create_fifo_data(start_val, exp_vals, QSPI_FIFO_MAX_BYTE, false);
-		if (!qspi_fram_quad_read_data(spi_ss, QSPI_FIFO_MAX_BYTE, exp_vals, mem_addr)) {
-			ret = false;
-		}
-		mem_addr += QSPI_FIFO_MAX_BYTE;
-	}
+static bool fram_ops_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t *buf,
+							uint32_t size)
+{
+	ARG_UNUSED(base);
 
-	return ret;
+	return qspi_fram_read(mem_no, mem_addr, buf, size);
+}
+
+static bool fram_ops_read_stream(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+									uint32_t size, qspi_read_sink_t sink, void *arg)
+{
+	ARG_UNUSED(base);
+
+	return qspi_fram_read_stream(mem_no, mem_addr, size, sink, arg);
 }
 
+const struct qspi_mem_ops qspi_fram_ops = {
+	.read = fram_ops_read,
+	.read_stream = fram_ops_read_stream,
+};
+
 uint32_t qspi_fram_initialize(uint32_t test_no)
 {
 	uint32_t err_cnt = 0;
+	uint32_t start_cycle;
 
 	info("* [%d] Start QSPI FRAM [MEM0]: Initialize\n", test_no);
+	start_cycle = k_cycle_get_32();
 	if (!qspi_fram_init(QSPI_FRAM_MEM0)) {
 		err_cnt++;
+	} else {
+		info("* FRAM 0: Initialized (%d us)\n", get_elapsed_us(start_cycle));
+		qspi_mem_params_print("FRAM 0", qspi_fram_get_params(QSPI_FRAM_MEM0));
 	}
 
 	info("* [%d] Start QSPI FRAM [MEM1]: Initialize\n", test_no);
+	start_cycle = k_cycle_get_32();
 	if (!qspi_fram_init(QSPI_FRAM_MEM1)) {
 		err_cnt++;
+	} else {
+		info("* FRAM 1: Initialized (%d us)\n", get_elapsed_us(start_cycle));
+		qspi_mem_params_print("FRAM 1", qspi_fram_get_params(QSPI_FRAM_MEM1));
 	}
 
 	return err_cnt;
@@ -536,8 +583,8 @@ uint32_t qspi_fram_initialize(uint32_t test_no)
 uint32_t qspi_fram_test(uint32_t test_no)
 {
 	uint32_t err_cnt = 0;
-	uint32_t write_data_0[QSPI_FIFO_MAX_BYTE] = {0x00};
-	uint32_t write_data_1[QSPI_FIFO_MAX_BYTE] = {0x00};
+	uint8_t write_data_0[QSPI_FIFO_MAX_BYTE] = {0x00};
+	uint8_t write_data_1[QSPI_FIFO_MAX_BYTE] = {0x00};
 	uint32_t mem_addr_0 = 0x000000;
 	uint32_t mem_addr_1 = 0x001000;
 	uint8_t start_val_0 = 0x20;
@@ -8,10 +8,35 @@
 #define SCOBCA1_FPGA_TEST_QSPI_FRAM_TEST_H_
 
 #include <zephyr/kernel.h>
+#include "qspi_common.h"
+#include "qspi_sfdp.h"
+#include "qspi_ctrl.h"
+
+#define QSPI_FRAM_MEM0 (0u)
+#define QSPI_FRAM_MEM1 (1u)
+#define QSPI_FRAM_DEV_NUM (2u)
+
+/* Record area on FRAM 0, which is not used by the FRAM tests */
+#define QSPI_FRAM_RECORD_ADDR (0x0007F000)
+#define QSPI_FRAM_RECORD_BYTE (0x00001000)
+#define QSPI_FRAM_CALIB_RECORD_ADDR (QSPI_FRAM_RECORD_ADDR)
+#define QSPI_FRAM_CALIB_PATTERN_ADDR (QSPI_FRAM_RECORD_ADDR + 0x0100)
+#define QSPI_FRAM_WEAR_RECORD_ADDR (QSPI_FRAM_RECORD_ADDR + 0x0200)
+
+extern const struct qspi_mem_ops qspi_fram_ops;
 
 uint32_t qspi_fram_initialize(uint32_t test_no);
 bool qspi_fram_multi_write(uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val);
 bool qspi_fram_multi_read(uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val);
+const struct qspi_mem_params *qspi_fram_get_params(uint8_t mem_no);
+bool qspi_fram_write(uint8_t mem_no, uint32_t mem_addr, const uint8_t *buf, uint32_t size);
+bool qspi_fram_write_stream(uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+							qspi_write_source_t source, void *arg);
+bool qspi_fram_broadcast_write(uint32_t mem_addr, const uint8_t *buf, uint32_t size,
+								bool *is_broadcast);
+bool qspi_fram_read(uint8_t mem_no, uint32_t mem_addr, uint8_t *buf, uint32_t size);
+bool qspi_fram_read_stream(uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+							qspi_read_sink_t sink, void *arg);
 uint32_t qspi_fram_test(uint32_t test_no);
 
 #endif /* SCOBCA1_FPGA_TEST_QSPI_FRAM_TESET_H_ */
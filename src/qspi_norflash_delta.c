@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/crc.h>
+#include "qspi_norflash_delta.h"
+#include "qspi_norflash_test.h"
+#include "hrmem_test.h"
+#include "common.h"
+
+/*
+ * Update the memory with the image, only on the sectors whose CRC is
+ * different from the image. The Erase is skipped on the blank sectors.
+ * `mem_addr` and `size` must be aligned to QSPI_NOR_FLASH_SECTOR_BYTE.
+ */
+bool qspi_norflash_delta_update(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+								const uint8_t *image, uint32_t size, uint32_t *update_count)
+{
+	uint32_t blank_crc = qspi_create_fifo_data_crc(0xFF, QSPI_NOR_FLASH_SECTOR_BYTE, true);
+	uint32_t start_cycle;
+	uint32_t addr;
+	uint32_t crc;
+	const uint8_t *data;
+
+	*update_count = 0;
+
+	if (mem_addr % QSPI_NOR_FLASH_SECTOR_BYTE != 0 || size % QSPI_NOR_FLASH_SECTOR_BYTE != 0) {
+		err("   Invalid delta update range (0x%08x, %d byte)\n", mem_addr, size);
+		return false;
+	}
+
+	start_cycle = k_cycle_get_32();
+	for (uint32_t offset=0; offset<size; offset+=QSPI_NOR_FLASH_SECTOR_BYTE) {
+		addr = mem_addr + offset;
+		data = &image[offset];
+
+		crc = 0;
+		if (!qspi_norflash_read_crc(base, mem_no, addr, QSPI_NOR_FLASH_SECTOR_BYTE, &crc)) {
+			assert();
+			return false;
+		}
+
+		if (crc == crc32_ieee(data, QSPI_NOR_FLASH_SECTOR_BYTE)) {
+			continue;
+		}
+
+		debug("* Update sector 0x%08x\n", addr);
+		if (crc != blank_crc) {
+			if (!qspi_norflash_erase(base, mem_no, QSPI_ERASE_SECTOR, addr, true, NULL)) {
+				assert();
+				return false;
+			}
+		}
+
+		if (!qspi_norflash_write_buf(base, mem_no, addr, data, QSPI_NOR_FLASH_SECTOR_BYTE)) {
+			assert();
+			return false;
+		}
+		(*update_count)++;
+	}
+
+	info("* Delta update: %d/%d sector updated (%d us)\n", *update_count,
+			size / QSPI_NOR_FLASH_SECTOR_BYTE, get_elapsed_us(start_cycle));
+
+	return true;
+}
+
+/*
+ *   1. Create image (Block:64KB) on HRMEM
+ *   2. Update Data Memory 0 with the image
+ *   3. Change one sector of the image, and update Data Memory 0 again
+ *      (only one sector is expected to be updated)
+ *   4. Verify Data Memory 0 with image CRC
+ */
+uint32_t qspi_norflash_delta_update_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t base = SCOBCA1_FPGA_DATA_BASE_ADDR;
+	uint32_t mem_addr = 0x00D00000;
+	uint32_t size = QSPI_NOR_FLASH_BLOCK_BYTE;
+	uint32_t image_addr = SCOBCA1_FPGA_HRMEM_MIRROR_BASE_ADDR + HRMEM_IMAGE_MEM_ADDR;
+	const uint8_t *image = (const uint8_t *)image_addr;
+	uint32_t change_addr = image_addr + 3 * QSPI_NOR_FLASH_SECTOR_BYTE;
+	uint32_t update_count;
+	uint32_t crc = 0;
+
+	info("* [%d] Start QSPI Data Memory Delta Update Test\n", test_no);
+
+	info("* [%d-1] Create image on HRMEM (0x%08x, Block:64KB)\n", test_no, image_addr);
+	for (uint32_t i=0; i<size/sizeof(uint32_t); i++) {
+		write32(image_addr + i * sizeof(uint32_t), ~i);
+	}
+
+	info("* [%d-2] Start QSPI Data Memory [0]: Delta Update Test\n", test_no);
+	if (!qspi_norflash_delta_update(base, QSPI_DATA_MEM0, mem_addr, image, size, &update_count)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-3] Start QSPI Data Memory [0]: Delta Update Test (1 sector changed)\n", test_no);
+	write32(change_addr, ~sys_read32(change_addr));
+	if (!qspi_norflash_delta_update(base, QSPI_DATA_MEM0, mem_addr, image, size, &update_count)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	if (update_count != 1) {
+		err("  !!! %d sector updated (exp:1)\n", update_count);
+		assert();
+		err_cnt++;
+	}
+
+	info("* [%d-4] Start QSPI Data Memory [0]: Verify image CRC\n", test_no);
+	if (!qspi_norflash_read_crc(base, QSPI_DATA_MEM0, mem_addr, size, &crc)) {
+		assert();
+		err_cnt++;
+	} else if (crc != crc32_ieee(image, size)) {
+		err("  !!! CRC mismatch 0x%08x (exp:0x%08x)\n", crc, crc32_ieee(image, size));
+		assert();
+		err_cnt++;
+	}
+
+end_of_test:
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
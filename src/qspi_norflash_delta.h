@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_NORFLASH_DELTA_H_
+#define SCOBCA1_FPGA_TEST_QSPI_NORFLASH_DELTA_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+bool qspi_norflash_delta_update(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+								const uint8_t *image, uint32_t size, uint32_t *update_count);
+uint32_t qspi_norflash_delta_update_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_NORFLASH_DELTA_H_ */
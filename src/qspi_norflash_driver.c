@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT sc_qspi_nor
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <string.h>
+#include <errno.h>
+#include "qspi_norflash_driver.h"
+#include "qspi_norflash_test.h"
+#include "common.h"
+
+#define QSPI_NOR_FLASH_ERASE_VALUE (0xFF)
+
+struct qspi_nor_config {
+	uint32_t base;
+	uint8_t mem_no;
+	uint32_t size;
+	struct flash_parameters parameters;
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	struct flash_pages_layout layout;
+#endif
+};
+
+struct qspi_nor_data {
+	bool is_init;
+};
+
+static bool is_valid_range(const struct qspi_nor_config *cfg, off_t offset, size_t len)
+{
+	return offset >= 0 && (size_t)offset <= cfg->size && len <= cfg->size - offset;
+}
+
+/* Enable QUAD I/O mode on the first access */
+static int qspi_nor_acquire(const struct device *dev)
+{
+	const struct qspi_nor_config *cfg = dev->config;
+	struct qspi_nor_data *data = dev->data;
+
+	/* Same lock as the other accesses to the controller */
+	qspi_ctrl_lock(cfg->base);
+
+	if (!data->is_init) {
+		if (!qspi_norflash_init(cfg->base, cfg->mem_no)) {
+			qspi_ctrl_unlock(cfg->base);
+			return -EIO;
+		}
+		data->is_init = true;
+	}
+
+	return 0;
+}
+
+static void qspi_nor_release(const struct device *dev)
+{
+	const struct qspi_nor_config *cfg = dev->config;
+
+	qspi_ctrl_unlock(cfg->base);
+}
+
+static int qspi_nor_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+	const struct qspi_nor_config *cfg = dev->config;
+	int ret;
+
+	if (!is_valid_range(cfg, offset, len)) {
+		return -EINVAL;
+	}
+
+	if (len == 0) {
+		return 0;
+	}
+
+	ret = qspi_nor_acquire(dev);
+	if (ret != 0) {
+		return ret;
+	}
+
+	if (!qspi_norflash_read_buf(cfg->base, cfg->mem_no, offset, data, len)) {
+		ret = -EIO;
+	}
+
+	qspi_nor_release(dev);
+
+	return ret;
+}
+
+static int qspi_nor_write(const struct device *dev, off_t offset, const void *data, size_t len)
+{
+	const struct qspi_nor_config *cfg = dev->config;
+	int ret;
+
+	if (!is_valid_range(cfg, offset, len)) {
+		return -EINVAL;
+	}
+
+	ret = qspi_nor_acquire(dev);
+	if (ret != 0) {
+		return ret;
+	}
+
+	if (!qspi_norflash_write_buf(cfg->base, cfg->mem_no, offset, data, len)) {
+		ret = -EIO;
+	}
+
+	qspi_nor_release(dev);
+
+	return ret;
+}
+
+static int qspi_nor_erase(const struct device *dev, off_t offset, size_t size)
+{
+	const struct qspi_nor_config *cfg = dev->config;
+	enum QspiEraseType type;
+	size_t erase_size;
+	int ret;
+
+	if (!is_valid_range(cfg, offset, size) ||
+			offset % QSPI_NOR_FLASH_SECTOR_BYTE != 0 || size % QSPI_NOR_FLASH_SECTOR_BYTE != 0) {
+		return -EINVAL;
+	}
+
+	ret = qspi_nor_acquire(dev);
+	if (ret != 0) {
+		return ret;
+	}
+
+	while (size > 0) {
+		if (offset % QSPI_NOR_FLASH_BLOCK_BYTE == 0 && size >= QSPI_NOR_FLASH_BLOCK_BYTE) {
+			type = QSPI_ERASE_BLOCK;
+			erase_size = QSPI_NOR_FLASH_BLOCK_BYTE;
+		} else {
+			type = QSPI_ERASE_SECTOR;
+			erase_size = QSPI_NOR_FLASH_SECTOR_BYTE;
+		}
+
+		if (!qspi_norflash_erase(cfg->base, cfg->mem_no, type, offset, true, NULL)) {
+			ret = -EIO;
+			break;
+		}
+
+		offset += erase_size;
+		size -= erase_size;
+	}
+
+	qspi_nor_release(dev);
+
+	return ret;
+}
+
+static const struct flash_parameters *qspi_nor_get_parameters(const struct device *dev)
+{
+	const struct qspi_nor_config *cfg = dev->config;
+
+	return &cfg->parameters;
+}
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+static void qspi_nor_pages_layout(const struct device *dev,
+									const struct flash_pages_layout **layout,
+									size_t *layout_size)
+{
+	const struct qspi_nor_config *cfg = dev->config;
+
+	*layout = &cfg->layout;
+	*layout_size = 1;
+}
+#endif
+
+static int qspi_nor_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	/* QUAD I/O mode is enabled on the first access */
+	return 0;
+}
+
+static const struct flash_driver_api qspi_nor_api = {
+	.read = qspi_nor_read,
+	.write = qspi_nor_write,
+	.erase = qspi_nor_erase,
+	.get_parameters = qspi_nor_get_parameters,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+	.page_layout = qspi_nor_pages_layout,
+#endif
+};
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+#define QSPI_NOR_LAYOUT(n)									\
+	.layout = {										\
+		.pages_count = DT_INST_PROP(n, size) / QSPI_NOR_FLASH_SECTOR_BYTE,		\
+		.pages_size = QSPI_NOR_FLASH_SECTOR_BYTE,					\
+	},
+#else
+#define QSPI_NOR_LAYOUT(n)
+#endif
+
+#define QSPI_NOR_INIT(n)									\
+	static const struct qspi_nor_config qspi_nor_config_##n = {			\
+		.base = DT_REG_ADDR(DT_INST_PARENT(n)),						\
+		.mem_no = DT_INST_REG_ADDR(n),							\
+		.size = DT_INST_PROP(n, size),							\
+		.parameters = {									\
+			.write_block_size = 1,							\
+			.erase_value = QSPI_NOR_FLASH_ERASE_VALUE,				\
+		},										\
+		QSPI_NOR_LAYOUT(n)								\
+	};											\
+	static struct qspi_nor_data qspi_nor_data_##n;						\
+	DEVICE_DT_INST_DEFINE(n, qspi_nor_init, NULL,						\
+				&qspi_nor_data_##n, &qspi_nor_config_##n,			\
+				POST_KERNEL, CONFIG_FLASH_INIT_PRIORITY,			\
+				&qspi_nor_api);
+
+DT_INST_FOREACH_STATUS_OKAY(QSPI_NOR_INIT)
+
+/*
+ *   1. Erase Data Memory 1 (Sector) by flash API
+ *   2. Write Data Memory 1 (Page) by flash API
+ *   3. Read Data Memory 1 (Page) by flash API and verify
+ */
+uint32_t qspi_norflash_driver_test(uint32_t test_no)
+{
+	const struct device *dev = DEVICE_DT_GET(DT_NODELABEL(data_mem1));
+	uint32_t err_cnt = 0;
+	off_t offset = 0x00E00000;
+	uint8_t write_data[QSPI_NOR_FLASH_PAGE_BYTE];
+	uint8_t read_data[QSPI_NOR_FLASH_PAGE_BYTE];
+
+	info("* [%d] Start QSPI Data Memory Flash Driver Test\n", test_no);
+
+	if (!device_is_ready(dev)) {
+		err("  !!! %s is not ready\n", dev->name);
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-1] Start flash_erase() Test (Sector)\n", test_no);
+	if (flash_erase(dev, offset, QSPI_NOR_FLASH_SECTOR_BYTE) != 0) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-2] Start flash_write() Test (Page)\n", test_no);
+	for (uint32_t i=0; i<sizeof(write_data); i++) {
+		write_data[i] = 0x90 + i;
+	}
+	if (flash_write(dev, offset, write_data, sizeof(write_data)) != 0) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-3] Start flash_read() Test (Page)\n", test_no);
+	if (flash_read(dev, offset, read_data, sizeof(read_data)) != 0) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	if (memcmp(write_data, read_data, sizeof(read_data)) != 0) {
+		err("  !!! Read data mismatch\n");
+		assert();
+		err_cnt++;
+	}
+
+end_of_test:
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
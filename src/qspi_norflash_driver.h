@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_NORFLASH_DRIVER_H_
+#define SCOBCA1_FPGA_TEST_QSPI_NORFLASH_DRIVER_H_
+
+#include <zephyr/kernel.h>
+
+uint32_t qspi_norflash_driver_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_NORFLASH_DRIVER_H_ */
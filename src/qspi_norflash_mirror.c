@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/sys/crc.h>
+#include "qspi_norflash_mirror.h"
+#include "qspi_norflash_test.h"
+#include "hrmem_test.h"
+#include "common.h"
+
+#define QSPI_CFG_MEM_NUM (2u)
+#define QSPI_NOR_FLASH_MIRROR_ERASE_POLL_US (100u)
+
+struct mirror_compare_ctx {
+	const uint32_t *ref;
+	uint32_t offset;
+	uint32_t diff;
+};
+
+static uint32_t sector_buf[QSPI_NOR_FLASH_SECTOR_BYTE / sizeof(uint32_t)];
+
+/*
+ * The order of Config Memory is reversed on every sector, so Config
+ * Memory is switched only once per sector.
+ */
+static uint8_t get_mirror_mem_no(uint32_t sector, uint8_t i)
+{
+	return (sector + i) % QSPI_CFG_MEM_NUM;
+}
+
+static bool wait_mirror_ready(uint8_t mem_no, enum NorflashBusyOp op, uint32_t busy_cycle,
+								uint32_t poll_us)
+{
+	bool is_ready = false;
+
+	while (true) {
+		if (!qspi_norflash_poll_ready(SCOBCA1_FPGA_CFG_BASE_ADDR, mem_no, op,
+										busy_cycle, &is_ready)) {
+			return false;
+		}
+		if (is_ready) {
+			return true;
+		}
+		if (poll_us > 0) {
+			k_usleep(poll_us);
+		}
+	}
+}
+
+/* XOR with the other copy by word (the RX burst size is a multiple of word) */
+static bool compare_read_data(const uint8_t *data, size_t size, void *arg)
+{
+	struct mirror_compare_ctx *ctx = arg;
+	uint32_t word;
+
+	for (uint32_t i=0; i<size; i+=sizeof(word)) {
+		memcpy(&word, &data[i], sizeof(word));
+		ctx->diff |= word ^ ctx->ref[(ctx->offset + i) / sizeof(word)];
+	}
+	ctx->offset += size;
+
+	return true;
+}
+
+static bool mirror_erase(uint32_t mem_addr, uint32_t size)
+{
+	uint32_t base = SCOBCA1_FPGA_CFG_BASE_ADDR;
+	uint32_t busy_cycle[QSPI_CFG_MEM_NUM];
+	enum QspiEraseType type;
+	uint32_t erase_size;
+	uint32_t offset = 0;
+
+	while (offset < size) {
+		if ((mem_addr + offset) % QSPI_NOR_FLASH_BLOCK_BYTE == 0 &&
+				size - offset >= QSPI_NOR_FLASH_BLOCK_BYTE) {
+			type = QSPI_ERASE_BLOCK;
+			erase_size = QSPI_NOR_FLASH_BLOCK_BYTE;
+		} else {
+			type = QSPI_ERASE_SECTOR;
+			erase_size = QSPI_NOR_FLASH_SECTOR_BYTE;
+		}
+
+		/* Erase both Config Memories at the same time */
+		for (uint8_t i=0; i<QSPI_CFG_MEM_NUM; i++) {
+			if (!qspi_norflash_erase(base, i, type, mem_addr + offset, false, NULL)) {
+				return false;
+			}
+			busy_cycle[i] = k_cycle_get_32();
+		}
+
+		/* Wait from the last (selected) Config Memory */
+		for (int8_t i=QSPI_CFG_MEM_NUM-1; i>=0; i--) {
+			if (!wait_mirror_ready(i, (enum NorflashBusyOp)type, busy_cycle[i],
+									QSPI_NOR_FLASH_MIRROR_ERASE_POLL_US)) {
+				return false;
+			}
+		}
+		offset += erase_size;
+	}
+
+	return true;
+}
+
+/*
+ * Program a sector to one Config Memory, and then the same sector to the
+ * other one, so Config Memory is switched only once per sector. The order
+ * is reversed on every sector like the compare. The second memory starts
+ * its first page while the first one finishes the last page of the
+ * sector. Both memories are on the same SPI bus, so only the page program (not
+ * the data transfer) overlaps.
+ */
+static bool mirror_program(uint32_t mem_addr, const uint8_t *image, uint32_t size)
+{
+	uint32_t base = SCOBCA1_FPGA_CFG_BASE_ADDR;
+	uint32_t busy_cycle[QSPI_CFG_MEM_NUM];
+	bool is_busy[QSPI_CFG_MEM_NUM] = {false, false};
+	uint32_t page_size = QSPI_NOR_FLASH_PAGE_BYTE;
+	uint32_t sector_offset;
+	uint32_t offset;
+	uint8_t mem_no;
+
+	for (uint8_t i=0; i<QSPI_CFG_MEM_NUM; i++) {
+		page_size = MIN(page_size, qspi_norflash_get_params(base, i)->page_size);
+	}
+
+	for (uint32_t sector=0; sector<size/QSPI_NOR_FLASH_SECTOR_BYTE; sector++) {
+		sector_offset = sector * QSPI_NOR_FLASH_SECTOR_BYTE;
+
+		for (uint8_t i=0; i<QSPI_CFG_MEM_NUM; i++) {
+			mem_no = get_mirror_mem_no(sector, i);
+
+			for (offset=sector_offset; offset<sector_offset+QSPI_NOR_FLASH_SECTOR_BYTE;
+					offset+=page_size) {
+				if (is_busy[mem_no] &&
+						!wait_mirror_ready(mem_no, NORFLASH_BUSY_PROGRAM, busy_cycle[mem_no], 0)) {
+					return false;
+				}
+				if (!qspi_norflash_page_program_start(base, mem_no, mem_addr + offset,
+														&image[offset], page_size)) {
+					return false;
+				}
+				busy_cycle[mem_no] = k_cycle_get_32();
+				is_busy[mem_no] = true;
+			}
+		}
+	}
+
+	for (uint8_t i=0; i<QSPI_CFG_MEM_NUM; i++) {
+		if (is_busy[i] && !wait_mirror_ready(i, NORFLASH_BUSY_PROGRAM, busy_cycle[i], 0)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Erase and program the same image into Config Memory 0 and 1 in a single
+ * pass, where the Erase and the page program of both memories overlap.
+ * `mem_addr` and `size` must be aligned to QSPI_NOR_FLASH_SECTOR_BYTE.
+ */
+bool qspi_config_memory_mirror_write(uint32_t mem_addr, const uint8_t *image, uint32_t size)
+{
+	uint32_t start_cycle;
+
+	if (mem_addr % QSPI_NOR_FLASH_SECTOR_BYTE != 0 || size % QSPI_NOR_FLASH_SECTOR_BYTE != 0) {
+		err("   Invalid mirrored write range (0x%08x, %d byte)\n", mem_addr, size);
+		return false;
+	}
+
+	start_cycle = k_cycle_get_32();
+	if (!mirror_erase(mem_addr, size)) {
+		assert();
+		return false;
+	}
+
+	if (!mirror_program(mem_addr, image, size)) {
+		assert();
+		return false;
+	}
+
+	qspi_print_throughput("Config Memory mirrored write", size, get_elapsed_us(start_cycle));
+
+	return true;
+}
+
+/*
+ * Read both copies by sector and compare them. `diff_count` is the number
+ * of sectors which are different between Config Memory 0 and 1.
+ */
+bool qspi_config_memory_mirror_compare(uint32_t mem_addr, uint32_t size, uint32_t *diff_count)
+{
+	uint32_t base = SCOBCA1_FPGA_CFG_BASE_ADDR;
+	uint32_t start_cycle;
+	uint32_t addr;
+	struct mirror_compare_ctx compare;
+
+	*diff_count = 0;
+
+	if (mem_addr % QSPI_NOR_FLASH_SECTOR_BYTE != 0 || size % QSPI_NOR_FLASH_SECTOR_BYTE != 0) {
+		err("   Invalid mirrored compare range (0x%08x, %d byte)\n", mem_addr, size);
+		return false;
+	}
+
+	start_cycle = k_cycle_get_32();
+	for (uint32_t sector=0; sector<size/QSPI_NOR_FLASH_SECTOR_BYTE; sector++) {
+		addr = mem_addr + sector * QSPI_NOR_FLASH_SECTOR_BYTE;
+
+		if (!qspi_norflash_read_buf(base, get_mirror_mem_no(sector, 0), addr,
+									(uint8_t *)sector_buf, QSPI_NOR_FLASH_SECTOR_BYTE)) {
+			assert();
+			return false;
+		}
+
+		compare.ref = sector_buf;
+		compare.offset = 0;
+		compare.diff = 0;
+		if (!qspi_norflash_read_stream(base, get_mirror_mem_no(sector, 1), addr,
+										QSPI_NOR_FLASH_SECTOR_BYTE, compare_read_data, &compare)) {
+			assert();
+			return false;
+		}
+
+		if (compare.diff != 0) {
+			err("  !!! Config Memory sector 0x%08x is different (XOR:0x%08x)\n",
+					addr, compare.diff);
+			(*diff_count)++;
+		}
+	}
+
+	qspi_print_throughput("Config Memory mirrored compare", size * QSPI_CFG_MEM_NUM,
+							get_elapsed_us(start_cycle));
+
+	return *diff_count == 0;
+}
+
+/*
+ *   1. Create image (Block:64KB) on HRMEM
+ *   2. Mirrored Write to Config Memory 0/1
+ *   3. Compare Config Memory 0/1
+ *   4. Verify Config Memory 0 with image CRC
+ */
+uint32_t qspi_config_memory_mirror_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t mem_addr = 0x00A00000;
+	uint32_t size = QSPI_NOR_FLASH_BLOCK_BYTE;
+	uint32_t image_addr = SCOBCA1_FPGA_HRMEM_MIRROR_BASE_ADDR + HRMEM_IMAGE_MEM_ADDR;
+	uint8_t *image = (uint8_t *)image_addr;
+	uint32_t diff_count;
+	uint32_t exp_crc;
+	uint32_t crc = 0;
+
+	info("* [%d] Start QSPI Config Memory Mirrored Test\n", test_no);
+
+	info("* [%d-1] Create image on HRMEM (0x%08x, Block:64KB)\n", test_no, image_addr);
+	for (uint32_t i=0; i<size/sizeof(uint32_t); i++) {
+		/* Different value on each sector */
+		write32(image_addr + i * sizeof(uint32_t),
+				i + (i * sizeof(uint32_t)) / QSPI_NOR_FLASH_SECTOR_BYTE * 0x01010101);
+	}
+	exp_crc = crc32_ieee(image, size);
+
+	info("* [%d-2] Start QSPI Config Memory [0/1]: Mirrored Write Test\n", test_no);
+	if (!qspi_config_memory_mirror_write(mem_addr, image, size)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-3] Start QSPI Config Memory [0/1]: Mirrored Compare Test\n", test_no);
+	if (!qspi_config_memory_mirror_compare(mem_addr, size, &diff_count)) {
+		err("  !!! %d sector is different\n", diff_count);
+		assert();
+		err_cnt++;
+	}
+
+	info("* [%d-4] Start QSPI Config Memory [0]: Verify image CRC\n", test_no);
+	if (!qspi_norflash_read_crc(SCOBCA1_FPGA_CFG_BASE_ADDR, QSPI_CFG_MEM0, mem_addr, size, &crc)) {
+		assert();
+		err_cnt++;
+	} else if (crc != exp_crc) {
+		err("  !!! CRC mismatch 0x%08x (exp:0x%08x)\n", crc, exp_crc);
+		assert();
+		err_cnt++;
+	}
+
+end_of_test:
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "qspi_norflash_sched.h"
+#include "qspi_norflash_test.h"
+#include "common.h"
+
+/* Sleep time when all devices are busy */
+#define QSPI_NOR_FLASH_SCHED_IDLE_US (10u)
+
+static uint8_t page_data[QSPI_NOR_FLASH_PAGE_BYTE];
+
+static bool sched_erase(struct norflash_sched_job *job)
+{
+	if (!qspi_norflash_erase(job->base, job->mem_no, QSPI_ERASE_BLOCK,
+								job->mem_addr + job->offset, false, NULL)) {
+		return false;
+	}
+	job->busy_cycle = k_cycle_get_32();
+	job->state = NORFLASH_SCHED_ERASING;
+
+	return true;
+}
+
+static bool sched_program(struct norflash_sched_job *job)
+{
+	for (uint32_t i=0; i<QSPI_NOR_FLASH_PAGE_BYTE; i++) {
+		page_data[i] = job->next_val++;
+	}
+
+	if (!qspi_norflash_page_program_start(job->base, job->mem_no, job->mem_addr + job->offset,
+											page_data, QSPI_NOR_FLASH_PAGE_BYTE)) {
+		return false;
+	}
+	job->busy_cycle = k_cycle_get_32();
+	job->state = NORFLASH_SCHED_PROGRAMMING;
+
+	return true;
+}
+
+/*
+ * Advance one job by one step. Busy devices are only polled once, so
+ * the other devices are handled while this device is erasing/programming.
+ */
+static bool sched_step(struct norflash_sched_job *job, bool *is_progress)
+{
+	bool is_ready = false;
+
+	switch (job->state) {
+	case NORFLASH_SCHED_ERASE:
+		*is_progress = true;
+		return sched_erase(job);
+	case NORFLASH_SCHED_ERASING:
+		if (!qspi_norflash_poll_ready(job->base, job->mem_no, NORFLASH_BUSY_BLOCK_ERASE,
+										job->busy_cycle, &is_ready)) {
+			return false;
+		}
+		if (!is_ready) {
+			return true;
+		}
+
+		*is_progress = true;
+		job->offset += QSPI_NOR_FLASH_BLOCK_BYTE;
+		if (job->offset < job->size) {
+			return sched_erase(job);
+		}
+		job->offset = 0;
+		return sched_program(job);
+	case NORFLASH_SCHED_PROGRAMMING:
+		if (!qspi_norflash_poll_ready(job->base, job->mem_no, NORFLASH_BUSY_PROGRAM,
+										job->busy_cycle, &is_ready)) {
+			return false;
+		}
+		if (!is_ready) {
+			return true;
+		}
+
+		*is_progress = true;
+		job->offset += QSPI_NOR_FLASH_PAGE_BYTE;
+		if (job->offset < job->size) {
+			return sched_program(job);
+		}
+		job->state = NORFLASH_SCHED_READ;
+		return true;
+	case NORFLASH_SCHED_READ:
+		*is_progress = true;
+		if (!qspi_norflash_bulk_read(job->base, job->mem_no, job->mem_addr,
+										job->size, job->start_val, false)) {
+			return false;
+		}
+		job->elapsed_us = get_elapsed_us(job->start_cycle);
+		job->state = NORFLASH_SCHED_DONE;
+		return true;
+	default:
+		err("   Invalid NOR flash scheduler state %d\n", job->state);
+		return false;
+	}
+}
+
+/*
+ * Erase, program and read back all jobs concurrently. Erases are issued
+ * to all devices back to back, and then the device which is ready is
+ * programmed or read while the others are still busy.
+ */
+bool qspi_norflash_sched_run(struct norflash_sched_job *jobs, uint8_t job_num)
+{
+	uint8_t remaining = job_num;
+	uint32_t total_size = 0;
+	uint32_t start_cycle;
+	bool is_progress;
+	bool ret = true;
+
+	if (job_num > QSPI_NOR_FLASH_SCHED_JOB_MAX) {
+		err("   Too many NOR flash scheduler jobs %d\n", job_num);
+		return false;
+	}
+
+	start_cycle = k_cycle_get_32();
+	for (uint8_t i=0; i<job_num; i++) {
+		if (jobs[i].mem_addr % QSPI_NOR_FLASH_BLOCK_BYTE != 0 ||
+				jobs[i].size == 0 || jobs[i].size % QSPI_NOR_FLASH_BLOCK_BYTE != 0) {
+			err("   Invalid NOR flash scheduler job (0x%08x, %d byte)\n",
+					jobs[i].mem_addr, jobs[i].size);
+			return false;
+		}
+		jobs[i].state = NORFLASH_SCHED_ERASE;
+		jobs[i].offset = 0;
+		jobs[i].next_val = jobs[i].start_val;
+		jobs[i].start_cycle = start_cycle;
+		jobs[i].elapsed_us = 0;
+		total_size += jobs[i].size;
+	}
+
+	while (remaining > 0) {
+		is_progress = false;
+		for (uint8_t i=0; i<job_num; i++) {
+			if (jobs[i].state == NORFLASH_SCHED_DONE ||
+					jobs[i].state == NORFLASH_SCHED_FAILED) {
+				continue;
+			}
+
+			if (!sched_step(&jobs[i], &is_progress)) {
+				err("  !!! NOR flash (0x%08x [%d]) failed at 0x%08x (state: %d)\n",
+						jobs[i].base, jobs[i].mem_no,
+						jobs[i].mem_addr + jobs[i].offset, jobs[i].state);
+				assert();
+				jobs[i].state = NORFLASH_SCHED_FAILED;
+				ret = false;
+			}
+
+			if (jobs[i].state == NORFLASH_SCHED_DONE ||
+					jobs[i].state == NORFLASH_SCHED_FAILED) {
+				remaining--;
+			}
+		}
+
+		if (!is_progress) {
+			k_usleep(QSPI_NOR_FLASH_SCHED_IDLE_US);
+		}
+	}
+
+	for (uint8_t i=0; i<job_num; i++) {
+		info("* NOR flash (0x%08x [%d]) erase/program/read: %d us\n",
+				jobs[i].base, jobs[i].mem_no, jobs[i].elapsed_us);
+	}
+	qspi_print_throughput("NOR flash erase/program/read (all devices)",
+							total_size, get_elapsed_us(start_cycle));
+
+	return ret;
+}
+
+uint32_t qspi_norflash_sched_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	struct norflash_sched_job jobs[] = {
+		{ SCOBCA1_FPGA_CFG_BASE_ADDR, QSPI_CFG_MEM0, 0x00A00000, QSPI_NOR_FLASH_BLOCK_BYTE, 0x00 },
+		{ SCOBCA1_FPGA_CFG_BASE_ADDR, QSPI_CFG_MEM1, 0x00B00000, QSPI_NOR_FLASH_BLOCK_BYTE, 0x10 },
+		{ SCOBCA1_FPGA_DATA_BASE_ADDR, QSPI_DATA_MEM0, 0x00A00000, QSPI_NOR_FLASH_BLOCK_BYTE, 0x20 },
+		{ SCOBCA1_FPGA_DATA_BASE_ADDR, QSPI_DATA_MEM1, 0x00B00000, QSPI_NOR_FLASH_BLOCK_BYTE, 0x30 },
+	};
+
+	info("* [%d] Start QSPI Config/Data Memory Concurrent Erase/Program/Read Test\n", test_no);
+
+	if (!qspi_norflash_sched_run(jobs, ARRAY_SIZE(jobs))) {
+		err_cnt++;
+	}
+
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_NORFLASH_SCHED_H_
+#define SCOBCA1_FPGA_TEST_QSPI_NORFLASH_SCHED_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+#define QSPI_NOR_FLASH_SCHED_JOB_MAX (4u)
+
+enum NorflashSchedState
+{
+	NORFLASH_SCHED_ERASE,
+	NORFLASH_SCHED_ERASING,
+	NORFLASH_SCHED_PROGRAMMING,
+	NORFLASH_SCHED_READ,
+	NORFLASH_SCHED_DONE,
+	NORFLASH_SCHED_FAILED,
+};
+
+/*
+ * Erase (Block), program and read back `size` byte on one NOR flash.
+ * `size` must be a multiple of QSPI_NOR_FLASH_BLOCK_BYTE.
+ */
+struct norflash_sched_job {
+	uint32_t base;
+	uint8_t mem_no;
+	uint32_t mem_addr;
+	uint32_t size;
+	uint8_t start_val;
+
+	/* Updated by the scheduler */
+	enum NorflashSchedState state;
+	uint32_t offset;
+	uint8_t next_val;
+	uint32_t busy_cycle;
+	uint32_t start_cycle;
+	uint32_t elapsed_us;
+};
+
+bool qspi_norflash_sched_run(struct norflash_sched_job *jobs, uint8_t job_num);
+uint32_t qspi_norflash_sched_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_NORFLASH_SCHED_H_ */
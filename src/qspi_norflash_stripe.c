@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/crc.h>
+#include "qspi_norflash_stripe.h"
+#include "qspi_norflash_test.h"
+#include "common.h"
+
+#define QSPI_NOR_FLASH_STRIPE_BASE (SCOBCA1_FPGA_DATA_BASE_ADDR)
+#define QSPI_NOR_FLASH_STRIPE_ERASE_POLL_US (100u)
+
+static uint8_t page_data[QSPI_NOR_FLASH_PAGE_BYTE];
+
+static uint8_t get_stripe_mem_no(uint32_t addr)
+{
+	return (addr / QSPI_NOR_FLASH_PAGE_BYTE) % QSPI_NOR_FLASH_STRIPE_DEV_NUM;
+}
+
+static uint32_t get_stripe_phys_addr(struct norflash_stripe *stripe, uint32_t addr)
+{
+	uint32_t page = addr / QSPI_NOR_FLASH_PAGE_BYTE;
+
+	return stripe->phys_addr + (page / QSPI_NOR_FLASH_STRIPE_DEV_NUM) * QSPI_NOR_FLASH_PAGE_BYTE +
+			addr % QSPI_NOR_FLASH_PAGE_BYTE;
+}
+
+static bool wait_stripe_ready(struct norflash_stripe *stripe, uint8_t mem_no,
+								enum NorflashBusyOp op, uint32_t poll_us)
+{
+	bool is_ready = false;
+
+	if (!stripe->is_busy[mem_no]) {
+		return true;
+	}
+
+	while (true) {
+		if (!qspi_norflash_poll_ready(QSPI_NOR_FLASH_STRIPE_BASE, mem_no, op,
+										stripe->busy_cycle[mem_no], &is_ready)) {
+			return false;
+		}
+		if (is_ready) {
+			break;
+		}
+		if (poll_us > 0) {
+			k_usleep(poll_us);
+		}
+	}
+	stripe->is_busy[mem_no] = false;
+
+	return true;
+}
+
+void qspi_norflash_stripe_init(struct norflash_stripe *stripe, uint32_t phys_addr)
+{
+	stripe->phys_addr = phys_addr;
+	for (uint8_t i=0; i<QSPI_NOR_FLASH_STRIPE_DEV_NUM; i++) {
+		stripe->is_busy[i] = false;
+		stripe->busy_cycle[i] = 0;
+	}
+}
+
+/*
+ * Erase the logical range. Both Data Memories are erased at the same time.
+ * `addr` and `size` must be aligned to QSPI_NOR_FLASH_STRIPE_BLOCK_BYTE.
+ */
+bool qspi_norflash_stripe_erase(struct norflash_stripe *stripe, uint32_t addr, uint32_t size)
+{
+	uint32_t phys_addr;
+
+	if (addr % QSPI_NOR_FLASH_STRIPE_BLOCK_BYTE != 0 ||
+			size % QSPI_NOR_FLASH_STRIPE_BLOCK_BYTE != 0) {
+		err("   Invalid striped erase range (0x%08x, %d byte)\n", addr, size);
+		return false;
+	}
+
+	if (!qspi_norflash_stripe_sync(stripe)) {
+		return false;
+	}
+
+	phys_addr = stripe->phys_addr + addr / QSPI_NOR_FLASH_STRIPE_DEV_NUM;
+	for (uint32_t offset=0; offset<size; offset+=QSPI_NOR_FLASH_STRIPE_BLOCK_BYTE) {
+		for (uint8_t i=0; i<QSPI_NOR_FLASH_STRIPE_DEV_NUM; i++) {
+			if (!qspi_norflash_erase(QSPI_NOR_FLASH_STRIPE_BASE, i, QSPI_ERASE_BLOCK,
+										phys_addr, false, NULL)) {
+				return false;
+			}
+			stripe->is_busy[i] = true;
+			stripe->busy_cycle[i] = k_cycle_get_32();
+		}
+
+		for (uint8_t i=0; i<QSPI_NOR_FLASH_STRIPE_DEV_NUM; i++) {
+			if (!wait_stripe_ready(stripe, i, NORFLASH_BUSY_BLOCK_ERASE,
+									QSPI_NOR_FLASH_STRIPE_ERASE_POLL_US)) {
+				return false;
+			}
+		}
+		phys_addr += QSPI_NOR_FLASH_BLOCK_BYTE;
+	}
+
+	return true;
+}
+
+/*
+ * Program the logical range page by page. A page is sent to one Data
+ * Memory while the other one is still programming the previous page.
+ * The last pages may be still in progress on return, so call
+ * qspi_norflash_stripe_sync() to wait for the completion.
+ */
+bool qspi_norflash_stripe_write(struct norflash_stripe *stripe, uint32_t addr,
+								const uint8_t *data, uint32_t size)
+{
+	uint8_t mem_no;
+	uint32_t write_size;
+
+	while (size > 0) {
+		mem_no = get_stripe_mem_no(addr);
+		write_size = MIN(size, QSPI_NOR_FLASH_PAGE_BYTE - (addr % QSPI_NOR_FLASH_PAGE_BYTE));
+
+		if (!wait_stripe_ready(stripe, mem_no, NORFLASH_BUSY_PROGRAM, 0)) {
+			return false;
+		}
+
+		if (!qspi_norflash_page_program_start(QSPI_NOR_FLASH_STRIPE_BASE, mem_no,
+												get_stripe_phys_addr(stripe, addr),
+												data, write_size)) {
+			return false;
+		}
+		stripe->is_busy[mem_no] = true;
+		stripe->busy_cycle[mem_no] = k_cycle_get_32();
+
+		addr += write_size;
+		data += write_size;
+		size -= write_size;
+	}
+
+	return true;
+}
+
+bool qspi_norflash_stripe_sync(struct norflash_stripe *stripe)
+{
+	for (uint8_t i=0; i<QSPI_NOR_FLASH_STRIPE_DEV_NUM; i++) {
+		if (!wait_stripe_ready(stripe, i, NORFLASH_BUSY_PROGRAM, 0)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Different value on each page, so that the page order is also verified */
+static void create_stripe_page(uint8_t start_val, uint32_t page)
+{
+	for (uint32_t i=0; i<QSPI_NOR_FLASH_PAGE_BYTE; i++) {
+		page_data[i] = start_val + page + i;
+	}
+}
+
+/*
+ *   1. Erase and Write Data Memory 0 (Block:64KB) as a single memory
+ *   2. Erase Striped Memory (128KB)
+ *   3. Write Striped Memory (128KB)
+ *   4. Read Data Memory 0/1 and verify CRC
+ */
+uint32_t qspi_data_memory_stripe_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t base = QSPI_NOR_FLASH_STRIPE_BASE;
+	uint32_t phys_addr = 0x00C00000;
+	uint32_t size = QSPI_NOR_FLASH_STRIPE_BLOCK_BYTE;
+	uint8_t start_val = 0x80;
+	struct norflash_stripe stripe;
+	uint32_t exp_crc[QSPI_NOR_FLASH_STRIPE_DEV_NUM] = {0};
+	uint32_t crc;
+	uint32_t start_cycle;
+	uint32_t single_us;
+	uint32_t stripe_us;
+
+	info("* [%d] Start QSPI Data Memory Striped Test\n", test_no);
+
+	info("* [%d-1] Start QSPI Data Memory [0]: Erase and Write Test (Block:64KB)\n", test_no);
+	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_BLOCK, phys_addr, true, NULL)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	start_cycle = k_cycle_get_32();
+	if (!qspi_norflash_multi_write(base, QSPI_DATA_MEM0, phys_addr,
+									QSPI_NOR_FLASH_BLOCK_BYTE, start_val)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	single_us = get_elapsed_us(start_cycle);
+
+	info("* [%d-2] Start QSPI Data Memory Striped: Erase Test (128KB)\n", test_no);
+	qspi_norflash_stripe_init(&stripe, phys_addr);
+	if (!qspi_norflash_stripe_erase(&stripe, 0, size)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+
+	info("* [%d-3] Start QSPI Data Memory Striped: Write Test (128KB)\n", test_no);
+	start_cycle = k_cycle_get_32();
+	for (uint32_t page=0; page<size/QSPI_NOR_FLASH_PAGE_BYTE; page++) {
+		create_stripe_page(start_val, page);
+		exp_crc[page % QSPI_NOR_FLASH_STRIPE_DEV_NUM] =
+			crc32_ieee_update(exp_crc[page % QSPI_NOR_FLASH_STRIPE_DEV_NUM],
+								page_data, QSPI_NOR_FLASH_PAGE_BYTE);
+		if (!qspi_norflash_stripe_write(&stripe, page * QSPI_NOR_FLASH_PAGE_BYTE,
+										page_data, QSPI_NOR_FLASH_PAGE_BYTE)) {
+			assert();
+			err_cnt++;
+			goto end_of_test;
+		}
+	}
+	if (!qspi_norflash_stripe_sync(&stripe)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	stripe_us = get_elapsed_us(start_cycle);
+
+	qspi_print_throughput("Single memory program", QSPI_NOR_FLASH_BLOCK_BYTE, single_us);
+	qspi_print_throughput("Striped memory program", size, stripe_us);
+
+	info("* [%d-4] Start QSPI Data Memory Striped: Read data Test (128KB)\n", test_no);
+	for (uint8_t i=0; i<QSPI_NOR_FLASH_STRIPE_DEV_NUM; i++) {
+		crc = 0;
+		if (!qspi_norflash_read_crc(base, i, phys_addr,
+									size / QSPI_NOR_FLASH_STRIPE_DEV_NUM, &crc)) {
+			assert();
+			err_cnt++;
+			continue;
+		}
+		if (crc != exp_crc[i]) {
+			err("  !!! Data Memory [%d] CRC mismatch 0x%08x (exp:0x%08x)\n",
+					i, crc, exp_crc[i]);
+			assert();
+			err_cnt++;
+		}
+	}
+
+end_of_test:
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_NORFLASH_STRIPE_H_
+#define SCOBCA1_FPGA_TEST_QSPI_NORFLASH_STRIPE_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+#define QSPI_NOR_FLASH_STRIPE_DEV_NUM (2u)
+/* Logical erase unit (one Block on each Data Memory) */
+#define QSPI_NOR_FLASH_STRIPE_BLOCK_BYTE (QSPI_NOR_FLASH_STRIPE_DEV_NUM * QSPI_NOR_FLASH_BLOCK_BYTE)
+
+/*
+ * Striped logical device on Data Memory 0/1. Consecutive pages
+ * (QSPI_NOR_FLASH_PAGE_BYTE) alternate between Data Memory 0 and 1.
+ */
+struct norflash_stripe {
+	uint32_t phys_addr;   /* Start address on each Data Memory */
+	bool is_busy[QSPI_NOR_FLASH_STRIPE_DEV_NUM];
+	uint32_t busy_cycle[QSPI_NOR_FLASH_STRIPE_DEV_NUM];
+};
+
+void qspi_norflash_stripe_init(struct norflash_stripe *stripe, uint32_t phys_addr);
+bool qspi_norflash_stripe_erase(struct norflash_stripe *stripe, uint32_t addr, uint32_t size);
+bool qspi_norflash_stripe_write(struct norflash_stripe *stripe, uint32_t addr,
+								const uint8_t *data, uint32_t size);
+bool qspi_norflash_stripe_sync(struct norflash_stripe *stripe);
+uint32_t qspi_data_memory_stripe_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_NORFLASH_STRIPE_H_ */
@@ -4,198 +4,620 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <zephyr/sys/crc.h>
+#include <string.h>
 #include "system_reg.h"
 #include "qspi_common.h"
+#include "qspi_ctrl.h"
+#include "qspi_norflash_test.h"
+#include "qspi_sfdp.h"
+#include "qspi_async.h"
+#include "qspi_norflash_wear.h"
 #include "common.h"
 #include "can.h"
 #include "trch_test.h"
 
 #define QSPI_NOR_FLASH_MEM_ADDR_SIZE (3u)
-#define QSPI_DATA_MEM0_SS (0x01)
-#define QSPI_DATA_MEM1_SS (0x02)
-#define QSPI_ASR_IDLE (0x00)
-#define QSPI_ASR_BUSY (0x01)
 #define QSPI_RX_FIFO_MAX_BYTE (16u)
+#define QSPI_NOR_FLASH_SR1_WIP (0x01)
+#define QSPI_NOR_FLASH_SR2_ES (0x02)
+#define QSPI_NOR_FLASH_VERIFY_ERR_PRINT_MAX (8u)
+#define QSPI_NOR_FLASH_SR1_QE (0x40)
+#define QSPI_SINGLE_CLOCKS_PER_BYTE (8u)
+#define QSPI_QUAD_CLOCKS_PER_BYTE (2u)
 #define QSPI_NOR_FLASH_DUMMY_CYCLE_COUNT (4u)
-#define QSPI_SPI_MODE_QUAD (0x00020000)
+
+struct norflash_verify_ctx {
+	uint32_t mem_addr;
+	uint8_t exp_val;
+	bool fill;
+	uint32_t err_cnt;
+};
+
+struct norflash_blank_ctx {
+	uint32_t mem_addr;
+	uint32_t fail_addr;
+	bool is_blank;
+};
+
+/* Busy polling: spin first, then sleep with exponential back-off */
+#define QSPI_NOR_FLASH_POLL_SPIN_COUNT (16u)
+#define QSPI_NOR_FLASH_POLL_MIN_US (10u)
+#define QSPI_NOR_FLASH_POLL_MAX_US (5000u)
+/* Learned timeout is used after this number of completions */
+#define QSPI_NOR_FLASH_LEARN_COUNT (4u)
+#define QSPI_NOR_FLASH_TIMEOUT_MARGIN (4u)
+/* Non-volatile Status/Configuration Register write */
+#define QSPI_NOR_FLASH_REGISTER_WRITE_TIMEOUT_US (1000000u)
+#define QSPI_NOR_FLASH_INIT_POLL_US (1000u)
+#define QSPI_NOR_FLASH_CR_QE (0x02)
+/* Erase Suspend (tSL) and the interval from Erase Resume to next Suspend (tRS) */
+#define QSPI_NOR_FLASH_SUSPEND_TIMEOUT_US (1000u)
+#define QSPI_NOR_FLASH_RESUME_INTERVAL_US (100u)
 
 #define TRCH_CFG_MEM_MONI_BIT   (2u)   /* TRCH RB2 */
 #define TRCH_CFG_MEM_MONI_MASK  (0x04)
 
+static const uint32_t norflash_erase_size[QSPI_ERASE_TYPE_NUM] = {
+	[QSPI_ERASE_SECTOR] = QSPI_NOR_FLASH_SECTOR_BYTE,
+	[QSPI_ERASE_HALF_BLOCK] = QSPI_NOR_FLASH_BLOCK_BYTE / 2,
+	[QSPI_ERASE_BLOCK] = QSPI_NOR_FLASH_BLOCK_BYTE,
+};
+
+/* Maximum busy time (us) to wait before any completion is learned */
+static const uint32_t norflash_default_timeout_us[NORFLASH_BUSY_OP_NUM] = {
+	[NORFLASH_BUSY_SECTOR_ERASE] = 1000000,
+	[NORFLASH_BUSY_HALF_BLOCK_ERASE] = 2000000,
+	[NORFLASH_BUSY_BLOCK_ERASE] = 3000000,
+	[NORFLASH_BUSY_PROGRAM] = 5000,
+};
+
+/* Learned busy time per device (Config Memory 0/1, Data Memory 0/1) */
+struct norflash_busy_timing {
+	uint32_t count;
+	uint32_t min_us;
+	uint32_t max_us;
+};
+
+static struct norflash_busy_timing norflash_timing[QSPI_NOR_FLASH_DEV_NUM][NORFLASH_BUSY_OP_NUM];
+
+/* Address of the Erase or Program in progress, to record the busy time by region */
+static uint32_t norflash_busy_addr[QSPI_NOR_FLASH_DEV_NUM];
+
+/*
+ * Busy time at the last poll with WIP=1. The device got ready between
+ * this and the poll with WIP=0, which can be late on the scheduler.
+ */
+static uint32_t norflash_poll_busy_us[QSPI_NOR_FLASH_DEV_NUM];
+
+/* Erase in progress, which is suspended while the device is read */
+struct norflash_suspend_state {
+	bool is_busy;                   /* Erase or Program is not finished */
+	enum NorflashBusyOp op;
+	uint32_t start_cycle;
+	uint32_t busy_us;               /* Busy time of the finished one */
+	bool is_erasing;
+	uint32_t erase_size;
+	bool is_resumed;
+	uint32_t resume_cycle;
+	uint32_t suspended_us;
+};
+
+static struct norflash_suspend_state norflash_suspend[QSPI_NOR_FLASH_DEV_NUM];
+static struct norflash_busy_timing norflash_suspend_timing[QSPI_NOR_FLASH_DEV_NUM];
+static struct norflash_busy_timing norflash_resume_timing[QSPI_NOR_FLASH_DEV_NUM];
+
+/* Initialization started by qspi_norflash_initialize_start() */
+struct norflash_init_state {
+	uint32_t start_cycle;
+	uint32_t init_us;
+	bool is_busy;
+	bool is_ok;
+};
+
+static struct norflash_init_state norflash_init_state[QSPI_NOR_FLASH_DEV_NUM];
+
+static const char *norflash_dev_name[QSPI_NOR_FLASH_DEV_NUM] = {
+	"Config Memory 0",
+	"Config Memory 1",
+	"Data Memory 0",
+	"Data Memory 1",
+};
+
+/* S25FL-L parameters, used when SFDP is not available */
+static const struct qspi_mem_params norflash_default_params = {
+	.size = 16 * 1024 * 1024,
+	.page_size = QSPI_NOR_FLASH_PAGE_BYTE,
+	.read_mode = QSPI_READ_MODE_1_4_4,
+	.read_opcode = 0xEB,
+	.read_mode_clocks = 2,
+	.read_dummy_clocks = QSPI_NOR_FLASH_DUMMY_CYCLE_COUNT * QSPI_QUAD_CLOCKS_PER_BYTE,
+	.erase_opcode = {
+		[QSPI_ERASE_SECTOR] = 0x20,
+		[QSPI_ERASE_HALF_BLOCK] = 0x52,
+		[QSPI_ERASE_BLOCK] = 0xD8,
+	},
+	.quad_enable = QSPI_QE_SR2_BIT1,
+};
+
+/* Discovered parameters per device (Config Memory 0/1, Data Memory 0/1) */
+static struct qspi_mem_params norflash_params[QSPI_NOR_FLASH_DEV_NUM];
+static bool is_norflash_params_valid[QSPI_NOR_FLASH_DEV_NUM];
+
+static uint8_t get_norflash_dev_index(uint32_t base, uint8_t mem_no)
+{
+	if (base == SCOBCA1_FPGA_CFG_BASE_ADDR) {
+		return mem_no;
+	}
+
+	return 2 + mem_no;
+}
+
+/* Inverse of get_norflash_dev_index() */
+static uint32_t get_norflash_base(uint8_t dev)
+{
+	return qspi_ctrl_get_by_id(dev < 2 ? QSPI_CTRL_CFG : QSPI_CTRL_DATA)->base;
+}
+
+static const struct qspi_mem_params *get_norflash_params(uint8_t dev)
+{
+	if (!is_norflash_params_valid[dev]) {
+		return &norflash_default_params;
+	}
+
+	return &norflash_params[dev];
+}
+
+const struct qspi_mem_params *qspi_norflash_get_params(uint32_t base, uint8_t mem_no)
+{
+	return get_norflash_params(get_norflash_dev_index(base, mem_no));
+}
+
+/* Name of the device index (Config Memory 0/1, Data Memory 0/1) */
+const char *qspi_norflash_get_dev_name(uint8_t dev)
+{
+	return norflash_dev_name[dev];
+}
+
+static uint32_t get_norflash_timeout(struct norflash_busy_timing *timing, enum NorflashBusyOp op)
+{
+	uint32_t timeout_us = norflash_default_timeout_us[op];
+
+	if (timing->count >= QSPI_NOR_FLASH_LEARN_COUNT) {
+		timeout_us = MIN(timing->max_us * QSPI_NOR_FLASH_TIMEOUT_MARGIN, timeout_us);
+	}
+
+	return timeout_us;
+}
+
+static void update_norflash_timing(struct norflash_busy_timing *timing, uint32_t elapsed_us)
+{
+	if (timing->count == 0 || elapsed_us < timing->min_us) {
+		timing->min_us = elapsed_us;
+	}
+	if (elapsed_us > timing->max_us) {
+		timing->max_us = elapsed_us;
+	}
+	timing->count++;
+}
+
+/* Busy time without the time suspended for the read */
+static uint32_t get_norflash_busy_us(uint8_t dev, uint32_t start_cycle)
+{
+	uint32_t elapsed = get_elapsed_us(start_cycle);
+
+	return elapsed - MIN(norflash_suspend[dev].suspended_us, elapsed);
+}
+
+static void set_norflash_busy(uint8_t dev, uint32_t mem_addr, enum NorflashBusyOp op)
+{
+	uint32_t erase_size = op == NORFLASH_BUSY_PROGRAM ? 0 : norflash_erase_size[op];
+
+	norflash_busy_addr[dev] = mem_addr;
+	norflash_poll_busy_us[dev] = 0;
+	norflash_suspend[dev].is_busy = true;
+	norflash_suspend[dev].op = op;
+	norflash_suspend[dev].start_cycle = k_cycle_get_32();
+	norflash_suspend[dev].is_erasing = erase_size > 0;
+	norflash_suspend[dev].erase_size = erase_size;
+	norflash_suspend[dev].is_resumed = false;
+	norflash_suspend[dev].suspended_us = 0;
+}
+
+/*
+ * Complete the Erase or Program seen ready at `elapsed` us. The busy time
+ * is taken at the middle of the last two polls, as the WIP transition is
+ * not seen directly, and returned. The completion already seen by the
+ * read is recorded only once.
+ */
+static uint32_t finish_norflash_busy(uint8_t dev, enum NorflashBusyOp op, uint32_t elapsed)
+{
+	uint32_t busy_us = norflash_poll_busy_us[dev];
+	uint32_t resolution = elapsed - MIN(busy_us, elapsed);
+
+	if (!norflash_suspend[dev].is_busy) {
+		return norflash_suspend[dev].busy_us;
+	}
+
+	busy_us += resolution / 2;
+	debug("* NOR flash [%d] is ready (%d us, polling resolution %d us)\n",
+			dev, busy_us, resolution);
+	update_norflash_timing(&norflash_timing[dev][op], busy_us);
+	qspi_norflash_wear_update(dev, op, norflash_busy_addr[dev], busy_us, resolution);
+	norflash_suspend[dev].is_busy = false;
+	norflash_suspend[dev].busy_us = busy_us;
+	norflash_suspend[dev].is_erasing = false;
+
+	return busy_us;
+}
+
+/* Complete the Erase seen ready by the read, not by its own poll */
+static void finish_norflash_erase(uint8_t dev)
+{
+	struct norflash_suspend_state *state = &norflash_suspend[dev];
+
+	finish_norflash_busy(dev, state->op, get_norflash_busy_us(dev, state->start_cycle));
+}
+
 static bool qspi_select_mem(uint32_t base, uint8_t mem_no, uint32_t *spi_ss)
 {
+	uint32_t memsel;
+	uint32_t exp_memctl;
+
 	if (base == SCOBCA1_FPGA_CFG_BASE_ADDR) {
 		/* Config Memory is switched by CFGMEMSEL */
 		if (mem_no == QSPI_DATA_MEM0) {
-			debug("* [#0] Select Config Memory 0\n");
-			write32(SCOBCA1_FPGA_SYSREG_CFGMEMCTL, 0x00);
-			if (!assert32(SCOBCA1_FPGA_SYSREG_CFGMEMCTL, 0x00, REG_READ_RETRY(100000))) {
-				err("  !!! Can not select Config Memory %d\n", mem_no);
-				return false;
-			}
+			memsel = 0x00;
+			exp_memctl = 0x00;
 		} else {
-			debug("* [#0] Select Config Memory 1\n");
-			write32(SCOBCA1_FPGA_SYSREG_CFGMEMCTL, 0x10);
-			if (!assert32(SCOBCA1_FPGA_SYSREG_CFGMEMCTL, 0x30, REG_READ_RETRY(100000))) {
+			memsel = 0x10;
+			exp_memctl = 0x30;
+		}
+
+		/* Switch only when the other Config Memory is selected */
+		if (sys_read32(SCOBCA1_FPGA_SYSREG_CFGMEMCTL) != exp_memctl) {
+			debug("* [#0] Select Config Memory %d\n", mem_no);
+			write32(SCOBCA1_FPGA_SYSREG_CFGMEMCTL, memsel);
+			if (!assert32(SCOBCA1_FPGA_SYSREG_CFGMEMCTL, exp_memctl, REG_READ_RETRY(100000))) {
 				err("  !!! Can not select Config Memory %d\n", mem_no);
 				return false;
 			}
 		}
-		*spi_ss = 0x01;
-	} else {
-		if (mem_no == QSPI_DATA_MEM0) {
-			*spi_ss = QSPI_DATA_MEM0_SS;
-		} else {
-			*spi_ss = QSPI_DATA_MEM1_SS;
-		}
 	}
+	*spi_ss = qspi_ctrl_get(base)->spi_ss[mem_no];
 
 	return true;
 }
 
-static bool is_qspi_idle(uint32_t base)
+static bool read_status_register1(uint32_t base, uint32_t spi_ss, uint8_t *status)
 {
-	debug("* Confirm QSPI Access Status is `Idle`\n");
-	if (!assert32(SCOBCA1_FPGA_NORFLASH_QSPI_ASR(base), QSPI_ASR_IDLE,
-			REG_READ_RETRY(10))) {
-		err("QSPI (Data Memory) is busy, so exit test\n");
-		return false;
-	}
-
-	return true;
+	return qspi_ctrl_read_register(base, spi_ss, 0x05, status);
 }
 
-static bool activate_spi_ss(uint32_t base, uint32_t spi_mode)
+/*
+ * Poll WIP bit on Status Register 1 until the device is ready.
+ * The polling interval is increased from QSPI_NOR_FLASH_POLL_MIN_US after
+ * QSPI_NOR_FLASH_POLL_SPIN_COUNT times of continuous polling, and the
+ * polling is started after the half of the fastest learned busy time.
+ */
+static bool wait_norflash_ready(uint32_t base, uint32_t spi_ss, uint8_t dev,
+								enum NorflashBusyOp op, uint32_t start_cycle,
+								uint32_t *elapsed_us)
 {
-	debug("* Activate SPI SS with %08x\n", spi_mode);
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_ACR(base), spi_mode);
-	if (!is_qspi_idle(base)) {
-		return false;
+	struct norflash_busy_timing *timing = &norflash_timing[dev][op];
+	uint32_t timeout_us = get_norflash_timeout(timing, op);
+	uint32_t poll_us = QSPI_NOR_FLASH_POLL_MIN_US;
+	uint32_t spin_count = 0;
+	uint32_t elapsed;
+	uint8_t status;
+
+	if (timing->count >= QSPI_NOR_FLASH_LEARN_COUNT &&
+			timing->min_us / 2 > QSPI_NOR_FLASH_POLL_MAX_US) {
+		k_usleep(timing->min_us / 2);
+	}
+
+	while (true) {
+		if (!read_status_register1(base, spi_ss, &status)) {
+			assert();
+			return false;
+		}
+
+		elapsed = get_norflash_busy_us(dev, start_cycle);
+		if ((status & QSPI_NOR_FLASH_SR1_WIP) == 0) {
+			break;
+		}
+
+		if (elapsed > timeout_us) {
+			err("  !!! NOR flash [%d] is busy (SR1:0x%02x, %d us, timeout: %d us)\n",
+					dev, status, elapsed, timeout_us);
+			return false;
+		}
+		norflash_poll_busy_us[dev] = elapsed;
+
+		if (spin_count < QSPI_NOR_FLASH_POLL_SPIN_COUNT) {
+			spin_count++;
+			continue;
+		}
+
+		k_usleep(poll_us);
+		poll_us = MIN(poll_us * 2, QSPI_NOR_FLASH_POLL_MAX_US);
+	}
+
+	elapsed = finish_norflash_busy(dev, op, elapsed);
+	if (elapsed_us != NULL) {
+		*elapsed_us = elapsed;
 	}
 
 	return true;
 }
 
-static bool inactivate_spi_ss(uint32_t base)
+/*
+ * The Erase started without waiting may be completed without a poll, and
+ * then it must not be suspended nor block the read any more.
+ */
+static bool update_norflash_erasing(uint32_t base, uint32_t spi_ss, uint8_t dev)
 {
-	debug("* Inactivate SPI SS\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_ACR(base), 0x00000000);
-	if (!is_qspi_idle(base)) {
+	struct norflash_suspend_state *state = &norflash_suspend[dev];
+	uint8_t status;
+
+	if (!state->is_erasing) {
+		return true;
+	}
+
+	if (!read_status_register1(base, spi_ss, &status)) {
+		assert();
 		return false;
 	}
+	if ((status & QSPI_NOR_FLASH_SR1_WIP) == 0) {
+		debug("* NOR flash [%d] Erase is already completed (SR1:0x%02x)\n", dev, status);
+		finish_norflash_erase(dev);
+	}
 
 	return true;
 }
 
-static void write_mem_addr_to_flash(uint32_t base, uint32_t mem_addr)
+/*
+ * Suspend the Erase in progress, and wait until the device is readable
+ * (WIP=0). `is_suspended` is not set when no Erase is in progress.
+ */
+static bool suspend_norflash_erase(uint32_t base, uint32_t spi_ss, uint8_t dev,
+									uint32_t *suspend_cycle, bool *is_suspended)
 {
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), (mem_addr & 0x00FF0000) >> 16);
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), (mem_addr & 0x0000FF00) >> 8);
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), (mem_addr & 0x000000FF));
-}
+	struct norflash_suspend_state *state = &norflash_suspend[dev];
+	uint32_t resume_us;
+	uint32_t elapsed;
+	uint8_t status;
 
-static void write_data_to_flash(uint32_t base, uint32_t *write_data, size_t size)
-{
-	debug("* Write TX FIFO %d byte\n", size);
-	for (uint8_t i=0; i<size; i++) {
-		write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), write_data[i]);
+	*is_suspended = false;
+
+	if (!state->is_erasing) {
+		return true;
 	}
-}
 
-static bool send_dummy_cycle(uint32_t base, uint8_t dummy_count)
-{
-	debug("* Send dummy cycle %d byte\n", dummy_count);
-	for (uint8_t i=0; i<dummy_count; i++) {
-		write32(SCOBCA1_FPGA_NORFLASH_QSPI_RDR(base), 0x00);
+	/* The Erase does not progress if it is suspended again too early */
+	if (state->is_resumed) {
+		resume_us = get_elapsed_us(state->resume_cycle);
+		if (resume_us < QSPI_NOR_FLASH_RESUME_INTERVAL_US) {
+			k_busy_wait(QSPI_NOR_FLASH_RESUME_INTERVAL_US - resume_us);
+		}
 	}
 
-	if (!is_qspi_idle(base)) {
+	*suspend_cycle = k_cycle_get_32();
+	if (!qspi_ctrl_send_command(base, spi_ss, 0x75)) {
+		return false;
+	}
+
+	while (true) {
+		if (!read_status_register1(base, spi_ss, &status)) {
+			assert();
+			return false;
+		}
+
+		elapsed = get_elapsed_us(*suspend_cycle);
+		if ((status & QSPI_NOR_FLASH_SR1_WIP) == 0) {
+			break;
+		}
+
+		if (elapsed > QSPI_NOR_FLASH_SUSPEND_TIMEOUT_US) {
+			err("  !!! NOR flash [%d] Erase Suspend timeout (SR1:0x%02x, %d us)\n",
+					dev, status, elapsed);
+			return false;
+		}
+	}
+
+	/*
+	 * WIP=0 is also seen when the Erase is completed just before the
+	 * Suspend, and then the read continues without the Resume
+	 */
+	if (!qspi_ctrl_read_register(base, spi_ss, 0x07, &status)) {
 		assert();
 		return false;
 	}
+	if ((status & QSPI_NOR_FLASH_SR2_ES) == 0) {
+		debug("* NOR flash [%d] Erase is completed before the Suspend (SR2:0x%02x)\n",
+				dev, status);
+		finish_norflash_erase(dev);
+		return true;
+	}
+
+	debug("* NOR flash [%d] Erase is suspended (%d us)\n", dev, elapsed);
+	update_norflash_timing(&norflash_suspend_timing[dev], elapsed);
+	*is_suspended = true;
 
-	debug("* Discard dummy data\n");
-	for (uint8_t i=0; i<dummy_count; i++) {
-		sys_read32(SCOBCA1_FPGA_NORFLASH_QSPI_RDR(base));
+	return true;
+}
+
+/* The suspended time is excluded from the busy time of the Erase */
+static bool resume_norflash_erase(uint32_t base, uint32_t spi_ss, uint8_t dev,
+									uint32_t suspend_cycle)
+{
+	struct norflash_suspend_state *state = &norflash_suspend[dev];
+	uint32_t start_cycle = k_cycle_get_32();
+	uint32_t elapsed;
+
+	if (!qspi_ctrl_send_command(base, spi_ss, 0x7A)) {
+		return false;
 	}
 
+	state->resume_cycle = k_cycle_get_32();
+	state->is_resumed = true;
+	state->suspended_us += get_elapsed_us(suspend_cycle);
+
+	elapsed = get_elapsed_us(start_cycle);
+	debug("* NOR flash [%d] Erase is resumed (%d us)\n", dev, elapsed);
+	update_norflash_timing(&norflash_resume_timing[dev], elapsed);
+
 	return true;
 }
 
-static bool read_and_verify_rx_data(uint32_t base, size_t exp_size, uint32_t *exp_val)
+static bool clear_status_register(uint32_t base, uint32_t spi_ss)
 {
-	bool ret = true;
+	/* Activate SPI SS with SINGLE-IO */
+	if (!qspi_ctrl_activate(base, spi_ss)) {
+		assert();
+		return false;
+	}
+
+	/* Clear All ISR */
+	write32(SCOBCA1_FPGA_QSPI_ISR(base), 0xFFFFFFFF);
 
-	debug("* Reqest RX FIFO %d byte\n", exp_size);
-	for (uint8_t i=0; i<exp_size; i++) {
-		write32(SCOBCA1_FPGA_NORFLASH_QSPI_RDR(base), 0x00);
+	debug("* Clear Status Register (Instructure:0x30) \n");
+	write32(SCOBCA1_FPGA_QSPI_TDR(base), 0x30);
+
+	/* Inactive SPI SS */
+	if (!qspi_ctrl_inactivate(base)) {
+		assert();
+		return false;
 	}
 
-	if (!is_qspi_idle(base)) {
+	/* Confirm SPI Control is Done */
+	if (!qspi_ctrl_is_control_done(base)) {
 		assert();
 		return false;
 	}
 
-	debug("* Read RX FIFO %d byte and verify the value\n", exp_size);
-	for (uint8_t i=0; i<exp_size; i++) {
-		if (!assert32(SCOBCA1_FPGA_NORFLASH_QSPI_RDR(base), exp_val[i],
-						REG_READ_RETRY(0))) {
-			ret = false;
+	return true;
+}
+
+static bool is_quad_io_mode(uint32_t base, uint32_t spi_ss, enum QspiQuadEnable quad_enable,
+							bool *is_enabled)
+{
+	uint8_t val;
+
+	if (quad_enable == QSPI_QE_SR1_BIT6) {
+		if (!read_status_register1(base, spi_ss, &val)) {
+			return false;
+		}
+		*is_enabled = (val & QSPI_NOR_FLASH_SR1_QE) != 0;
+	} else {
+		if (!qspi_ctrl_read_register(base, spi_ss, 0x35, &val)) {
+			return false;
 		}
+		*is_enabled = (val & QSPI_NOR_FLASH_CR_QE) != 0;
 	}
 
-	return ret;
+	return true;
 }
 
-static bool is_qspi_control_done(uint32_t base)
+bool qspi_memory_data_erase(uint32_t base, uint32_t spi_ss, uint8_t dev,
+							enum QspiEraseType type, uint32_t mem_addr)
 {
-	debug("* Confirm QSPI Interrupt Stauts is `SPI Control Done`\n");
-	if (!assert32(SCOBCA1_FPGA_NORFLASH_QSPI_ISR(base), 0x01, REG_READ_RETRY(10))) {
+	const struct qspi_mem_params *params = get_norflash_params(dev);
+	struct qspi_cmd cmd = {
+		.addr_byte = QSPI_ADDR_BYTE,
+		.addr = mem_addr,
+	};
+
+	if (type >= QSPI_ERASE_TYPE_NUM || params->erase_opcode[type] == 0x00) {
 		assert();
+		err("   Invalid Erase Type %d\n", type);
 		return false;
 	}
 
-	debug("* Clear QSPI Interrupt Stauts\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_ISR(base), 0x01);
-	if (!assert32(SCOBCA1_FPGA_NORFLASH_QSPI_ISR(base), 0x00, REG_READ_RETRY(10))) {
+	debug("* Send Erase instruction (Type:%d, 0x%02x)\n", type, params->erase_opcode[type]);
+	cmd.opcode = params->erase_opcode[type];
+	if (!qspi_ctrl_exec(base, spi_ss, &cmd)) {
 		assert();
 		return false;
 	}
+	set_norflash_busy(dev, mem_addr, (enum NorflashBusyOp)type);
 
 	return true;
 }
 
-static bool verify_status_resisger1(uint32_t base, uint32_t spi_ss, size_t exp_size, uint32_t *exp_val)
+/*
+ * Send the Quad Read instruction, the address, the mode and the dummy
+ * cycle by the discovered read mode, and keep SPI SS with QUAD-IO for
+ * the read data.
+ */
+static bool send_quad_read_command(uint32_t base, uint32_t spi_ss, uint8_t dev,
+									uint32_t mem_addr)
 {
-	bool ret;
+	const struct qspi_mem_params *params = get_norflash_params(dev);
+	uint8_t clocks_per_byte;
 
-	/* Activate SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(base, spi_ss)) {
+	/* Active SPI SS with SINGLE-IO */
+	if (!qspi_ctrl_activate(base, spi_ss)) {
 		assert();
 		return false;
 	}
 
-	debug("* Request Status Register 1\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x05);
-	if (!is_qspi_idle(base)) {
+	debug("* Set QUAD read mode (0x%02x)\n", params->read_opcode);
+	write32(SCOBCA1_FPGA_QSPI_TDR(base), params->read_opcode);
+	if (!qspi_ctrl_is_idle(base)) {
 		assert();
 		return false;
 	}
 
-	/* Read Memory data (2byte) adn Verify */
-	ret = read_and_verify_rx_data(base, exp_size, exp_val);
-	if (!ret) {
+	if (params->read_mode == QSPI_READ_MODE_1_4_4) {
+		debug("* Activate SPI SS with Quad-IO SPI Mode\n");
+		write32(SCOBCA1_FPGA_QSPI_ACR(base), QSPI_SPI_MODE_QUAD + spi_ss);
+		clocks_per_byte = QSPI_QUAD_CLOCKS_PER_BYTE;
+	} else {
+		clocks_per_byte = QSPI_SINGLE_CLOCKS_PER_BYTE;
+	}
+
+	debug("* Send Memory Address (3byte)\n");
+	qspi_ctrl_write_addr(base, mem_addr);
+
+	debug("* Send Mode (0x00)\n");
+	for (uint8_t i=0; i<params->read_mode_clocks/clocks_per_byte; i++) {
+		write32(SCOBCA1_FPGA_QSPI_TDR(base), 0x00);
+	}
+
+	/* Send Dummy Cycle */
+	if (!qspi_ctrl_send_dummy(base, params->read_dummy_clocks / clocks_per_byte)) {
 		assert();
+		return false;
 	}
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss(base)) {
+	if (params->read_mode == QSPI_READ_MODE_1_1_4) {
+		debug("* Activate SPI SS with Quad-IO SPI Mode\n");
+		write32(SCOBCA1_FPGA_QSPI_ACR(base), QSPI_SPI_MODE_QUAD + spi_ss);
+	}
+
+	return true;
+}
+
+static bool qspi_norflash_quad_read_data(uint32_t base, uint32_t spi_ss, uint8_t dev,
+										uint32_t mem_addr, uint8_t read_size,
+										const uint8_t *exp_vals)
+{
+	bool ret;
+
+	if (!send_quad_read_command(base, spi_ss, dev, mem_addr)) {
 		assert();
 		return false;
 	}
 
-	/* Confirm SPI Control is Done */
-	if (!is_qspi_control_done(base)) {
+	/* Read Initial RX data and verify */
+	ret = qspi_ctrl_read_and_verify(base, read_size, exp_vals);
+	if (!ret) {
+		assert();
+	}
+
+	/* Inactive the SPI SS */
+	if (!qspi_ctrl_inactivate(base)) {
 		assert();
 		return false;
 	}
@@ -203,140 +625,416 @@ static bool verify_status_resisger1(uint32_t base, uint32_t spi_ss, size_t exp_s
 	return ret;
 }
 
-static bool clear_status_register(uint32_t base, uint32_t spi_ss)
+/*
+ * Read the whole range by a single Quad I/O Read command. The address,
+ * the mode and the dummy cycle are sent only once.
+ */
+static bool qspi_norflash_quad_read_stream(uint32_t base, uint32_t spi_ss, uint8_t dev,
+										uint32_t mem_addr, uint32_t size, uint8_t *buf,
+										qspi_read_sink_t sink, void *arg)
 {
-	/* Activate SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(base, spi_ss)) {
-		assert();
+	const struct qspi_mem_params *params = get_norflash_params(dev);
+	uint8_t clocks_per_byte = params->read_mode == QSPI_READ_MODE_1_4_4 ?
+								QSPI_QUAD_CLOCKS_PER_BYTE : QSPI_SINGLE_CLOCKS_PER_BYTE;
+	struct qspi_cmd cmd = {
+		.opcode = params->read_opcode,
+		.io = params->read_mode == QSPI_READ_MODE_1_4_4 ? QSPI_IO_1_4_4 : QSPI_IO_1_1_4,
+		.addr_byte = QSPI_ADDR_BYTE,
+		.addr = mem_addr,
+		.mode_byte = params->read_mode_clocks / clocks_per_byte,
+		.dummy_byte = params->read_dummy_clocks / clocks_per_byte,
+		.dir = QSPI_CMD_DIR_RX,
+		.size = size,
+		.rx_buf = buf,
+		.sink = sink,
+		.arg = arg,
+	};
+
+	return qspi_ctrl_exec(base, spi_ss, &cmd);
+}
+
+/* Read by qspi_norflash_quad_read_stream() with the Erase in progress suspended */
+static bool read_stream_with_suspend(uint32_t base, uint32_t spi_ss, uint8_t dev,
+										uint32_t mem_addr, uint32_t size, uint8_t *buf,
+										qspi_read_sink_t sink, void *arg)
+{
+	struct norflash_suspend_state *state = &norflash_suspend[dev];
+	uint32_t erase_addr = norflash_busy_addr[dev] & ~(state->erase_size - 1);
+	uint32_t suspend_cycle;
+	bool is_suspended;
+	bool ret;
+
+	if (!update_norflash_erasing(base, spi_ss, dev)) {
 		return false;
 	}
 
-	/* Clear All ISR */
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_ISR(base), 0xFFFFFFFF);
-
-	debug("* Clear Status Register (Instructure:0x30) \n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x30);
+	/* The erasing Block returns indeterminate data while it is suspended */
+	if (state->is_erasing && mem_addr < erase_addr + state->erase_size &&
+			erase_addr < mem_addr + size) {
+		err("  !!! NOR flash [%d] 0x%08x-0x%08x is being erased\n",
+				dev, erase_addr, erase_addr + state->erase_size - 1);
+		return false;
+	}
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss(base)) {
+	if (!suspend_norflash_erase(base, spi_ss, dev, &suspend_cycle, &is_suspended)) {
 		assert();
 		return false;
 	}
 
-	/* Confirm SPI Control is Done */
-	if (!is_qspi_control_done(base)) {
+	ret = qspi_norflash_quad_read_stream(base, spi_ss, dev, mem_addr, size, buf, sink, arg);
+
+	if (is_suspended && !resume_norflash_erase(base, spi_ss, dev, suspend_cycle)) {
 		assert();
 		return false;
 	}
 
+	return ret;
+}
+
+/*
+ * Read JEDEC ID and SFDP in SINGLE-IO mode. The default parameters are
+ * used for the memory without SFDP.
+ */
+static bool discover_norflash_params(uint32_t base, uint32_t spi_ss, uint8_t dev)
+{
+	struct qspi_mem_params *params = &norflash_params[dev];
+	struct qspi_ctrl_sfdp_ctx ctx = {
+		.base = base,
+		.spi_ss = spi_ss,
+	};
+
+	*params = norflash_default_params;
+	is_norflash_params_valid[dev] = false;
+
+	if (!qspi_ctrl_read_jedec_id(base, spi_ss, params->jedec_id)) {
+		return false;
+	}
+
+	if (!qspi_sfdp_discover(qspi_ctrl_read_sfdp, &ctx, params)) {
+		debug("* NOR flash [%d] has no SFDP, use the default parameters\n", dev);
+	}
+
+	/* The read data and page buffers are up to QSPI_NOR_FLASH_PAGE_BYTE */
+	params->page_size = MIN(params->page_size, QSPI_NOR_FLASH_PAGE_BYTE);
+	is_norflash_params_valid[dev] = true;
+
 	return true;
 }
 
-static bool set_write_enable(uint32_t base, uint32_t spi_ss)
+/*
+ * Discover the parameters and start to enable QUAD I/O mode. The
+ * Status/Configuration Register is written only when QUAD I/O mode is not
+ * enabled yet, and `is_busy` is set until the write is completed.
+ */
+static bool start_norflash_init(uint32_t base, uint8_t mem_no, bool *is_busy)
 {
-	uint32_t exp_write_enable[] = {0x02, 0x02};
+	uint32_t spi_ss;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
+	const struct qspi_mem_params *params;
+	bool is_enabled = false;
+	uint8_t qe_val[] = {0x00, QSPI_NOR_FLASH_CR_QE};
+	size_t qe_size = ARRAY_SIZE(qe_val);
 
-	/* Active SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(base, spi_ss)) {
+	*is_busy = false;
+
+	if (mem_no > 1) {
+		err("   !!! Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+		return false;
+	}
+
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
+		return false;
+	}
+
+	debug("* [#0] Discover JEDEC ID and SFDP\n");
+	if (!discover_norflash_params(base, spi_ss, dev)) {
 		assert();
 		return false;
 	}
+	params = get_norflash_params(dev);
 
-	debug("* Set `Write Enable` (Instructure:0x06) \n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x06);
+	debug("* [#1] Clear Status Register\n");
+	if (!clear_status_register(base, spi_ss)) {
+		assert();
+		return false;
+	}
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss(base)) {
+	if (params->quad_enable == QSPI_QE_NONE) {
+		debug("* QUAD I/O mode is always enabled\n");
+		return true;
+	}
+
+	if (!is_quad_io_mode(base, spi_ss, params->quad_enable, &is_enabled)) {
 		assert();
 		return false;
 	}
+	if (is_enabled) {
+		debug("* QUAD I/O mode is already enabled\n");
+		return true;
+	}
 
-	/* Confirm SPI Control is Done */
-	if (!is_qspi_control_done(base)) {
+	debug("* [#2] Set to `Write Enable'\n");
+	if (!qspi_ctrl_set_write_enable(base, spi_ss, true)) {
 		assert();
 		return false;
 	}
 
-	if (!verify_status_resisger1(base, spi_ss, ARRAY_SIZE(exp_write_enable), exp_write_enable)) {
+	/* Write Registers (0x01) with Status Register 1 and Configuration Register */
+	if (params->quad_enable == QSPI_QE_SR1_BIT6) {
+		qe_val[0] = QSPI_NOR_FLASH_SR1_QE;
+		qe_size = 1;
+	}
+
+	debug("* [#3] Set to `QUAD I/O modee'\n");
+	if (!qspi_ctrl_set_quad_io_mode(base, spi_ss, 0x01, qe_val, qe_size)) {
 		assert();
 		return false;
 	}
+	*is_busy = true;
 
 	return true;
 }
 
-static bool set_quad_io_mode(uint32_t base, uint32_t spi_ss)
+/*
+ * Check WIP bit once, and verify QUAD I/O mode when the register write
+ * started by start_norflash_init() is completed.
+ */
+static bool poll_norflash_init(uint32_t base, uint8_t mem_no, uint32_t start_cycle,
+								bool *is_ready)
 {
-	/* Activate SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(base, spi_ss)) {
-		assert();
+	uint32_t spi_ss;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
+	uint8_t exp_sr1_quad_mode[] = {QSPI_NOR_FLASH_SR1_QE};
+	uint8_t exp_cr_quad_mode[] = {QSPI_NOR_FLASH_CR_QE, QSPI_NOR_FLASH_CR_QE};
+	uint32_t elapsed;
+	uint8_t status;
+	bool ret;
+
+	*is_ready = false;
+
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
 		return false;
 	}
 
-	debug("* Set QUAD I/O mode to configuration register\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x01);
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x00);
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x02);
-	if (!is_qspi_idle(base)) {
+	if (!read_status_register1(base, spi_ss, &status)) {
 		assert();
 		return false;
 	}
 
-	/* Inactivate SPI SS */
-	if (!inactivate_spi_ss(base)) {
+	elapsed = get_elapsed_us(start_cycle);
+	if (status & QSPI_NOR_FLASH_SR1_WIP) {
+		if (elapsed > QSPI_NOR_FLASH_REGISTER_WRITE_TIMEOUT_US) {
+			err("  !!! NOR flash [%d] register write timeout (SR1:0x%02x, %d us)\n",
+					dev, status, elapsed);
+			return false;
+		}
+		return true;
+	}
+
+	debug("* [#4] Verify QUAD I/O mode is enabled (%d us)\n", elapsed);
+	if (get_norflash_params(dev)->quad_enable == QSPI_QE_SR1_BIT6) {
+		ret = qspi_ctrl_verify_quad_io_mode(base, spi_ss, 0x05, ARRAY_SIZE(exp_sr1_quad_mode),
+											exp_sr1_quad_mode);
+	} else {
+		ret = qspi_ctrl_verify_quad_io_mode(base, spi_ss, 0x35, ARRAY_SIZE(exp_cr_quad_mode),
+											exp_cr_quad_mode);
+	}
+	if (!ret) {
 		assert();
 		return false;
 	}
+	*is_ready = true;
 
-	/* Confirm SPI Control is Done */
-	if(!is_qspi_control_done(base)) {
-		assert();
+	return true;
+}
+
+static bool norflash_init(uint32_t base, uint8_t mem_no)
+{
+	uint32_t start_cycle = k_cycle_get_32();
+	bool is_busy;
+	bool is_ready = false;
+
+	if (!start_norflash_init(base, mem_no, &is_busy)) {
 		return false;
 	}
 
+	while (is_busy && !is_ready) {
+		k_usleep(QSPI_NOR_FLASH_INIT_POLL_US);
+		if (!poll_norflash_init(base, mem_no, start_cycle, &is_ready)) {
+			return false;
+		}
+	}
+
 	return true;
 }
 
-static bool verify_config_register(uint32_t base, uint32_t spi_ss, size_t exp_size, uint32_t *exp_val)
+bool qspi_norflash_init(uint32_t base, uint8_t mem_no)
 {
 	bool ret;
 
-	/* Activate SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(base, spi_ss)) {
+	qspi_ctrl_lock(base);
+	ret = norflash_init(base, mem_no);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+static bool crc_read_data(const uint8_t *data, size_t size, void *arg)
+{
+	uint32_t *crc = arg;
+
+	*crc = crc32_ieee_update(*crc, data, size);
+
+	return true;
+}
+
+static bool verify_read_data(const uint8_t *data, size_t size, void *arg)
+{
+	struct norflash_verify_ctx *ctx = arg;
+	bool ret = true;
+
+	for (uint32_t i=0; i<size; i++) {
+		if (data[i] != ctx->exp_val) {
+			if (ctx->err_cnt < QSPI_NOR_FLASH_VERIFY_ERR_PRINT_MAX) {
+				err("  read [0x%08x] 0x%02x (exp:0x%02x)\n",
+						ctx->mem_addr + i, data[i], ctx->exp_val);
+			}
+			ctx->err_cnt++;
+			ret = false;
+		}
+		if (!ctx->fill) {
+			ctx->exp_val++;
+		}
+	}
+	ctx->mem_addr += size;
+
+	return ret;
+}
+
+/* AND all words of the RX burst, and find the first non-blank byte only if any */
+static bool blank_check_read_data(const uint8_t *data, size_t size, void *arg)
+{
+	struct norflash_blank_ctx *ctx = arg;
+	uint32_t and_word = 0xFFFFFFFF;
+	uint32_t word;
+	uint32_t i;
+
+	if (!ctx->is_blank) {
+		return true;
+	}
+
+	for (i=0; i+sizeof(word)<=size; i+=sizeof(word)) {
+		memcpy(&word, &data[i], sizeof(word));
+		and_word &= word;
+	}
+	for (; i<size; i++) {
+		and_word &= 0xFFFFFF00 | data[i];
+	}
+
+	if (and_word != 0xFFFFFFFF) {
+		for (i=0; i<size; i++) {
+			if (data[i] != 0xFF) {
+				break;
+			}
+		}
+		ctx->fail_addr = ctx->mem_addr + i;
+		ctx->is_blank = false;
+	}
+	ctx->mem_addr += size;
+
+	return true;
+}
+
+static bool qspi_memory_data_quad_page_write(uint32_t base, uint32_t spi_ss, uint32_t mem_addr,
+											const uint8_t *write_data, size_t write_size)
+{
+	struct qspi_cmd cmd = {
+		.opcode = 0x32,
+		.io = QSPI_IO_1_1_4,
+		.addr_byte = QSPI_ADDR_BYTE,
+		.addr = mem_addr,
+		.dir = QSPI_CMD_DIR_TX,
+		.size = write_size,
+		.tx_data = write_data,
+	};
+
+	debug("* Send QUAD Page program instruction\n");
+	return qspi_ctrl_exec(base, spi_ss, &cmd);
+}
+
+static bool start_page_program(uint32_t base, uint32_t spi_ss, uint8_t dev, uint32_t mem_addr,
+								const uint8_t *write_data, size_t write_size)
+{
+	uint32_t page_size = get_norflash_params(dev)->page_size;
+
+	if (write_size > page_size - (mem_addr % page_size)) {
+		err("   Page program crosses the page boundary (0x%08x, %d byte)\n",
+				mem_addr, write_size);
+		return false;
+	}
+
+	if (!qspi_ctrl_set_write_enable(base, spi_ss, true)) {
 		assert();
 		return false;
 	}
 
-	debug("* Request Configuration Register\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x35);
-	if (!is_qspi_idle(base)) {
+	if (!qspi_memory_data_quad_page_write(base, spi_ss, mem_addr, write_data, write_size)) {
 		assert();
 		return false;
 	}
+	set_norflash_busy(dev, mem_addr, NORFLASH_BUSY_PROGRAM);
 
-	/* Read Memory data (2byte) adn Verify */
-	ret = read_and_verify_rx_data(base, exp_size, exp_val);
+	return true;
+}
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss(base)) {
+/*
+ * Program up to one page (256 byte) by a single Quad Page Program, and
+ * wait for the completion.
+ */
+static bool qspi_norflash_page_program(uint32_t base, uint32_t spi_ss, uint8_t dev,
+									uint32_t mem_addr, const uint8_t *write_data,
+									size_t write_size)
+{
+	uint8_t exp_write_disable[] = {0x00, 0x00};
+
+	if (!start_page_program(base, spi_ss, dev, mem_addr, write_data, write_size)) {
+		return false;
+	}
+
+	if (!wait_norflash_ready(base, spi_ss, dev, NORFLASH_BUSY_PROGRAM,
+								k_cycle_get_32(), NULL)) {
 		assert();
 		return false;
 	}
 
-	/* Confirm SPI Control is Done */
-	if (!is_qspi_control_done(base)) {
+	if (!qspi_ctrl_verify_status_register1(base, spi_ss, ARRAY_SIZE(exp_write_disable), exp_write_disable)) {
 		assert();
 		return false;
 	}
 
-	return ret;
+	return true;
 }
 
-static bool verify_quad_io_mode(uint32_t base, uint32_t spi_ss)
+/*
+ * Start a Quad Page Program of up to one page (256 byte) without waiting
+ * for the completion. The completion is checked by qspi_norflash_poll_ready().
+ */
+static bool norflash_page_program_start(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+									const uint8_t *write_data, size_t write_size)
 {
-	uint32_t exp_quad_mode[2] = {0x02, 0x02};
+	uint32_t spi_ss;
+
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+		return false;
+	}
+
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
+		return false;
+	}
 
-	if (!verify_config_register(base, spi_ss, ARRAY_SIZE(exp_quad_mode), exp_quad_mode)) {
+	if (!start_page_program(base, spi_ss, get_norflash_dev_index(base, mem_no), mem_addr,
+							write_data, write_size)) {
 		assert();
 		return false;
 	}
@@ -344,12 +1042,37 @@ static bool verify_quad_io_mode(uint32_t base, uint32_t spi_ss)
 	return true;
 }
 
-static bool qspi_norflash_init(uint32_t base, uint8_t mem_no)
+bool qspi_norflash_page_program_start(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+									const uint8_t *write_data, size_t write_size)
+{
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_page_program_start(base, mem_no, mem_addr, write_data, write_size);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+/*
+ * Check WIP bit once without waiting. `is_ready` is set when the Erase or
+ * Program started at `start_cycle` is completed, and false is returned if
+ * the device is busy longer than the timeout or reports an error.
+ */
+static bool norflash_poll_ready(uint32_t base, uint8_t mem_no, enum NorflashBusyOp op,
+								uint32_t start_cycle, bool *is_ready)
 {
 	uint32_t spi_ss;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
+	struct norflash_busy_timing *timing = &norflash_timing[dev][op];
+	uint32_t timeout_us = get_norflash_timeout(timing, op);
+	uint32_t elapsed;
+	uint8_t status;
+
+	*is_ready = false;
 
 	if (mem_no > 1) {
-		err("   !!! Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
 		return false;
 	}
 
@@ -357,72 +1080,125 @@ static bool qspi_norflash_init(uint32_t base, uint8_t mem_no)
 		return false;
 	}
 
-	debug("* [#1] Clear Status Register\n");
-	if (!clear_status_register(base, spi_ss)) {
+	if (!read_status_register1(base, spi_ss, &status)) {
 		assert();
 		return false;
 	}
 
-	debug("* [#2] Set to `Write Enable'\n");
-	if (!set_write_enable(base, spi_ss)) {
-		assert();
-		return false;
+	elapsed = get_norflash_busy_us(dev, start_cycle);
+	if (status & QSPI_NOR_FLASH_SR1_WIP) {
+		if (elapsed > timeout_us) {
+			err("  !!! NOR flash [%d] is busy (SR1:0x%02x, %d us, timeout: %d us)\n",
+					dev, status, elapsed, timeout_us);
+			return false;
+		}
+		norflash_poll_busy_us[dev] = elapsed;
+		return true;
 	}
 
-	debug("* [#3] Set to `QUAD I/O modee'\n");
-	if (!set_quad_io_mode(base, spi_ss)) {
-		assert();
+	if (status != 0x00) {
+		err("  !!! NOR flash [%d] operation %d failed (SR1:0x%02x)\n", dev, op, status);
 		return false;
 	}
 
-	/* Wait 1 sec */
-	k_sleep(K_MSEC(1000));
+	finish_norflash_busy(dev, op, elapsed);
+	*is_ready = true;
 
-	debug("* [#4] Verify Configuration Register is QUAD I/O mode (0x02)\n");
-	if (!verify_quad_io_mode(base, spi_ss)) {
-		assert();
+	return true;
+}
+
+bool qspi_norflash_poll_ready(uint32_t base, uint8_t mem_no, enum NorflashBusyOp op,
+								uint32_t start_cycle, bool *is_ready)
+{
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_poll_ready(base, mem_no, op, start_cycle, is_ready);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+/* Wait for the Erase or Program started at `start_cycle` */
+static bool norflash_wait_ready(uint32_t base, uint8_t mem_no, enum NorflashBusyOp op,
+								uint32_t start_cycle)
+{
+	uint32_t spi_ss;
+
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
 		return false;
 	}
 
-	return true;
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
+		return false;
+	}
+
+	return wait_norflash_ready(base, spi_ss, get_norflash_dev_index(base, mem_no), op,
+								start_cycle, NULL);
 }
 
-bool qspi_memory_data_erase(uint32_t base, uint32_t spi_ss, enum QspiEraseType type, uint32_t mem_addr)
+bool qspi_norflash_wait_ready(uint32_t base, uint8_t mem_no, enum NorflashBusyOp op,
+								uint32_t start_cycle)
 {
-	/* Activate SPI SS */
-	if (!activate_spi_ss(base, spi_ss)) {
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_wait_ready(base, mem_no, op, start_cycle);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+static bool norflash_erase(uint32_t base, uint8_t mem_no, enum QspiEraseType type,
+								uint32_t mem_addr, bool is_wait_idle, uint32_t *erase_time_us)
+{
+	uint32_t spi_ss;
+	uint32_t start_cycle;
+	uint8_t exp_write_disable[] = {0x00, 0x00};
+
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+		return false;
+	}
+
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
+		return false;
+	}
+
+	debug("* [#1] Clear Status Register\n");
+	if (!clear_status_register(base, spi_ss)) {
 		assert();
 		return false;
 	}
 
-	switch (type) {
-	case QSPI_ERASE_SECTOR:
-		debug("* Send Sector (4KB) Erase instruction\n");
-		write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x20);
-		break;
-	case QSPI_ERASE_HALF_BLOCK:
-		debug("* Send Sector (32KB) Erase instruction\n");
-		write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x52);
-		break;
-	case QSPI_ERASE_BLOCK:
-		debug("* Send Block (64KB) Erase instruction\n");
-		write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0xD8);
-		break;
-	default:
+	debug("* [#2] Set to `Write Enable'\n");
+	if (!qspi_ctrl_set_write_enable(base, spi_ss, true)) {
 		assert();
-		err("   Invalid Erase Type %d\n", type);
 		return false;
 	}
 
-	debug("* Send Memory Address (3byte)\n");
-	write_mem_addr_to_flash(base, mem_addr);
-	if (!is_qspi_idle(base)) {
+	debug("* [#3] Erase\n");
+	if (!qspi_memory_data_erase(base, spi_ss, get_norflash_dev_index(base, mem_no),
+								type, mem_addr)) {
 		assert();
 		return false;
 	}
+	start_cycle = k_cycle_get_32();
 
-	/* Inactive the SPI SS */
-	if (!inactivate_spi_ss(base)) {
+	if (!is_wait_idle) {
+		return true;
+	}
+
+	debug("* [#4] Wait for Erase completion (WIP=0)\n");
+	if (!wait_norflash_ready(base, spi_ss, get_norflash_dev_index(base, mem_no),
+								(enum NorflashBusyOp)type, start_cycle, erase_time_us)) {
+		assert();
+		return false;
+	}
+
+	if (!qspi_ctrl_verify_status_register1(base, spi_ss,
+					ARRAY_SIZE(exp_write_disable), exp_write_disable)) {
 		assert();
 		return false;
 	}
@@ -430,104 +1206,183 @@ bool qspi_memory_data_erase(uint32_t base, uint32_t spi_ss, enum QspiEraseType t
 	return true;
 }
 
-static bool qspi_norflash_set_quad_read_mode(uint32_t base, uint32_t spi_ss)
+bool qspi_norflash_erase(uint32_t base, uint8_t mem_no, enum QspiEraseType type,
+								uint32_t mem_addr, bool is_wait_idle, uint32_t *erase_time_us)
 {
-	/* Active SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(base, spi_ss)) {
-		assert();
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_erase(base, mem_no, type, mem_addr, is_wait_idle, erase_time_us);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+static bool norflash_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t read_size, const uint8_t *exp_vals)
+{
+	uint32_t spi_ss;
+
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+		return false;
+	}
+
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
 		return false;
 	}
 
-	debug("* Set QUAD-IO read mode\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0xEB);
-	if (!is_qspi_idle(base)) {
+	debug("* [#1] Read Data (QUAD-IO Mode) \n");
+	if (!qspi_norflash_quad_read_data(base, spi_ss, get_norflash_dev_index(base, mem_no),
+										mem_addr, read_size, exp_vals)) {
 		assert();
 		return false;
 	}
 
-	/* Keep SPI SS for QUAD Read */
 	return true;
 }
 
-static bool qspi_norflash_quad_read_data(uint32_t base, uint32_t spi_ss, uint32_t mem_addr,
-										uint8_t read_size, uint32_t *exp_vals)
+bool qspi_norflash_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t read_size, const uint8_t *exp_vals)
 {
 	bool ret;
 
-	debug("* Activate SPI SS with Quad-IO SPI Mode\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_ACR(base), QSPI_SPI_MODE_QUAD + spi_ss);
+	qspi_ctrl_lock(base);
+	ret = norflash_read(base, mem_no, mem_addr, read_size, exp_vals);
+	qspi_ctrl_unlock(base);
 
-	debug("* Send Memory Address (3byte)\n");
-	write_mem_addr_to_flash(base, mem_addr);
+	return ret;
+}
 
-	debug("* Send Mode (0x00)\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x00);
+static bool norflash_multi_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								uint8_t start_val, bool is_init)
+{
+	bool ret = true;
+	uint32_t spi_ss;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
+	uint8_t exp_vals[QSPI_RX_FIFO_MAX_BYTE];
+	uint16_t loop_count;
+	uint32_t start_cycle;
 
-	/* Send Dummy Cycle */
-	send_dummy_cycle(base, QSPI_NOR_FLASH_DUMMY_CYCLE_COUNT);
-	if (!is_qspi_idle(base)) {
-		assert();
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
 		return false;
 	}
 
-	/* Read Initial RX data and verify */
-	ret = read_and_verify_rx_data(base, read_size, exp_vals);
-	if (!ret) {
-		assert();
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
+		return false;
 	}
 
-	/* Inactive the SPI SS */
-	if (!inactivate_spi_ss(base)) {
+	debug("* [#1] Clear Status Register\n");
+	if (!clear_status_register(base, spi_ss)) {
 		assert();
 		return false;
 	}
 
+	start_cycle = k_cycle_get_32();
+	loop_count = size/QSPI_RX_FIFO_MAX_BYTE;
+	for (uint16_t i=0; i<loop_count; i++) {
+
+		debug("* [#2] Read Data (QUAD-IO Mode) \n");
+		if (is_init) {
+			qspi_create_fifo_data(0xFF, exp_vals, QSPI_RX_FIFO_MAX_BYTE, true);
+		} else {
+			start_val = qspi_create_fifo_data(start_val, exp_vals, QSPI_RX_FIFO_MAX_BYTE, false);
+		}
+
+		if (!qspi_norflash_quad_read_data(base, spi_ss, dev, mem_addr,
+											QSPI_RX_FIFO_MAX_BYTE, exp_vals)) {
+			ret = false;
+		}
+		mem_addr += QSPI_RX_FIFO_MAX_BYTE;
+	}
+
+	qspi_print_throughput("NOR flash read", size, get_elapsed_us(start_cycle));
+
 	return ret;
 }
 
-static bool qspi_memory_data_quad_write(uint32_t base, uint32_t spi_ss, uint32_t mem_addr,
-										uint8_t write_size, uint32_t *write_data)
+bool qspi_norflash_multi_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								uint8_t start_val, bool is_init)
 {
-	/* Active SPI SS with SINGLE-IO */
-	if (!activate_spi_ss(base, spi_ss)) {
-		assert();
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_multi_read(base, mem_no, mem_addr, size, start_val, is_init);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+static bool norflash_bulk_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								uint8_t start_val, bool is_init)
+{
+	bool ret;
+	uint32_t spi_ss;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
+	uint32_t start_cycle;
+	uint32_t crc = 0;
+	uint32_t exp_crc;
+	struct norflash_verify_ctx ctx = {
+		.mem_addr = mem_addr,
+		.exp_val = is_init ? 0xFF : start_val,
+		.fill = is_init,
+		.err_cnt = 0,
+	};
+
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
 		return false;
 	}
 
-	debug("* Snd QUAD Page program instruction\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_TDR(base), 0x32);
-
-	debug("* Send Memory Address (3byte)\n");
-	write_mem_addr_to_flash(base, mem_addr);
-	if (!is_qspi_idle(base)) {
-		assert();
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
 		return false;
 	}
 
-	debug("* Activate SPI SS with Quad-IO SPI Mode\n");
-	write32(SCOBCA1_FPGA_NORFLASH_QSPI_ACR(base), QSPI_SPI_MODE_QUAD + spi_ss);
+	exp_crc = qspi_create_fifo_data_crc(ctx.exp_val, size, ctx.fill);
 
-	/* Write data */
-	write_data_to_flash(base, write_data, write_size);
-	if (!is_qspi_idle(base)) {
+	debug("* [#1] Read Data (QUAD-IO Mode, continuous) and calculate CRC\n");
+	start_cycle = k_cycle_get_32();
+	ret = read_stream_with_suspend(base, spi_ss, dev, mem_addr, size, NULL, crc_read_data, &crc);
+	qspi_print_throughput("NOR flash bulk read", size, get_elapsed_us(start_cycle));
+	if (!ret) {
 		assert();
 		return false;
 	}
 
-	/* Inactive SPI SS */
-	if (!inactivate_spi_ss(base)) {
-		assert();
-		return false;
+	if (crc == exp_crc) {
+		return true;
 	}
 
-	return true;
+	err("  !!! CRC mismatch 0x%08x (exp:0x%08x), verify each byte\n", crc, exp_crc);
+	debug("* [#2] Read Data (QUAD-IO Mode, continuous) and verify each byte\n");
+	read_stream_with_suspend(base, spi_ss, dev, mem_addr, size, NULL, verify_read_data, &ctx);
+	err("  !!! Assertion failed: %d byte mismatch\n", ctx.err_cnt);
+	assert();
+
+	return false;
 }
 
-bool qspi_norflash_erase(uint32_t base, uint8_t mem_no, enum QspiEraseType type,
-								uint32_t mem_addr, bool is_wait_idle)
+bool qspi_norflash_bulk_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								uint8_t start_val, bool is_init)
+{
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_bulk_read(base, mem_no, mem_addr, size, start_val, is_init);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+/*
+ * Read `size` byte by continuous Quad I/O Read, and hand the read data
+ * to `sink` for each RX FIFO burst. The Erase started without waiting is
+ * suspended during the read, and the read of the erasing range fails.
+ */
+static bool norflash_read_stream(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								qspi_read_sink_t sink, void *arg)
 {
 	uint32_t spi_ss;
-	uint32_t exp_write_disable[] = {0x00, 0x00};
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
 
 	if (mem_no > 1) {
 		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
@@ -538,54 +1393,35 @@ bool qspi_norflash_erase(uint32_t base, uint8_t mem_no, enum QspiEraseType type,
 		return false;
 	}
 
-	debug("* [#1] Clear Status Register\n");
-	if (!clear_status_register(base, spi_ss)) {
-		assert();
-		return false;
-	}
-
-	debug("* [#2] Set to `Write Enable'\n");
-	if (!set_write_enable(base, spi_ss)) {
-		assert();
-		return false;
-	}
-
-	debug("* [#3] Erase\n");
-	if (!qspi_memory_data_erase(base, spi_ss, type, mem_addr)) {
+	if (!read_stream_with_suspend(base, spi_ss, dev, mem_addr, size, NULL, sink, arg)) {
 		assert();
 		return false;
 	}
 
-	if (!is_wait_idle) {
-		return true;
-	}
+	return true;
+}
 
-	switch (type) {
-	case QSPI_ERASE_SECTOR:
-		k_sleep(K_MSEC(300));
-		break;
-	case QSPI_ERASE_HALF_BLOCK:
-		k_sleep(K_MSEC(400));
-		break;
-	case QSPI_ERASE_BLOCK:
-		k_sleep(K_MSEC(800));
-		break;
-	default:
-		break;
-	}
+bool qspi_norflash_read_stream(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								qspi_read_sink_t sink, void *arg)
+{
+	bool ret;
 
-	if (!verify_status_resisger1(base, spi_ss,
-					ARRAY_SIZE(exp_write_disable), exp_write_disable)) {
-		assert();
-		return false;
-	}
+	qspi_ctrl_lock(base);
+	ret = norflash_read_stream(base, mem_no, mem_addr, size, sink, arg);
+	qspi_ctrl_unlock(base);
 
-	return true;
+	return ret;
 }
 
-bool qspi_norflash_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t read_size, uint32_t *exp_vals)
+/*
+ * Read `size` byte into `buf` directly from RX FIFO. The Erase in
+ * progress is suspended as qspi_norflash_read_stream().
+ */
+static bool norflash_read_buf(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t *buf,
+							uint32_t size)
 {
 	uint32_t spi_ss;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
 
 	if (mem_no > 1) {
 		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
@@ -596,14 +1432,7 @@ bool qspi_norflash_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_
 		return false;
 	}
 
-	debug("* [#1] Set QUAD-IO Read Mode\n");
-	if (!qspi_norflash_set_quad_read_mode(base, spi_ss)) {
-		assert();
-		return false;
-	}
-
-	debug("* [#2] Read Data (QUAD-IO Mode) \n");
-	if (!qspi_norflash_quad_read_data(base, spi_ss, mem_addr, read_size, exp_vals)) {
+	if (!read_stream_with_suspend(base, spi_ss, dev, mem_addr, size, buf, NULL, NULL)) {
 		assert();
 		return false;
 	}
@@ -611,13 +1440,36 @@ bool qspi_norflash_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_
 	return true;
 }
 
-bool qspi_norflash_multi_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
-								uint8_t start_val, bool is_init)
+bool qspi_norflash_read_buf(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t *buf,
+							uint32_t size)
+{
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_read_buf(base, mem_no, mem_addr, buf, size);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+/*
+ * Check that the range is erased (all 0xFF) by continuous Quad I/O Read
+ * of each Block, and stop at the Block which has the first non-blank
+ * byte. `fail_addr` (optional) is the address of that byte. False is
+ * returned only when the read itself is failed.
+ */
+static bool norflash_blank_check(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								bool *is_blank, uint32_t *fail_addr)
 {
-	bool ret = true;
 	uint32_t spi_ss;
-	uint32_t exp_vals[QSPI_RX_FIFO_MAX_BYTE];
-	uint16_t loop_count;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
+	uint32_t start_cycle;
+	uint32_t read_size;
+	struct norflash_blank_ctx ctx = {
+		.mem_addr = mem_addr,
+		.fail_addr = 0,
+		.is_blank = true,
+	};
 
 	if (mem_no > 1) {
 		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
@@ -628,42 +1480,54 @@ bool qspi_norflash_multi_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
 		return false;
 	}
 
-	debug("* [#1] Clear Status Register\n");
-	if (!clear_status_register(base, spi_ss)) {
-		assert();
-		return false;
-	}
-
-	loop_count = size/QSPI_RX_FIFO_MAX_BYTE;
-	for (uint16_t i=0; i<loop_count; i++) {
-
-		debug("* [#2] Set QUAD-IO Read Mode\n");
-		if (!qspi_norflash_set_quad_read_mode(base, spi_ss)) {
+	start_cycle = k_cycle_get_32();
+	while (ctx.is_blank && ctx.mem_addr < mem_addr + size) {
+		read_size = MIN(mem_addr + size - ctx.mem_addr,
+						QSPI_NOR_FLASH_BLOCK_BYTE - ctx.mem_addr % QSPI_NOR_FLASH_BLOCK_BYTE);
+		if (!read_stream_with_suspend(base, spi_ss, dev, ctx.mem_addr, read_size, NULL,
+										blank_check_read_data, &ctx)) {
 			assert();
 			return false;
 		}
+	}
+	qspi_print_throughput("NOR flash blank check", ctx.mem_addr - mem_addr,
+							get_elapsed_us(start_cycle));
 
-		debug("* [#3] Read Data (QUAD-IO Mode) \n");
-		if (is_init) {
-			qspi_create_fifo_data(0xFF, exp_vals, QSPI_RX_FIFO_MAX_BYTE, true);
-		} else {
-			start_val = qspi_create_fifo_data(start_val, exp_vals, QSPI_RX_FIFO_MAX_BYTE, false);
-		}
-
-		if (!qspi_norflash_quad_read_data(base, spi_ss, mem_addr, QSPI_RX_FIFO_MAX_BYTE, exp_vals)) {
-			ret = false;
+	*is_blank = ctx.is_blank;
+	if (!ctx.is_blank) {
+		debug("* NOR flash [%d] is not blank at 0x%08x\n", dev, ctx.fail_addr);
+		if (fail_addr != NULL) {
+			*fail_addr = ctx.fail_addr;
 		}
-		mem_addr += QSPI_RX_FIFO_MAX_BYTE;
 	}
 
+	return true;
+}
+
+bool qspi_norflash_blank_check(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								bool *is_blank, uint32_t *fail_addr)
+{
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_blank_check(base, mem_no, mem_addr, size, is_blank, fail_addr);
+	qspi_ctrl_unlock(base);
+
 	return ret;
 }
 
-bool qspi_norflash_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
-						uint8_t write_size, uint32_t *write_data)
+/* Read `size` byte and update `crc` with the read data */
+bool qspi_norflash_read_crc(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+							uint32_t *crc)
+{
+	return qspi_norflash_read_stream(base, mem_no, mem_addr, size, crc_read_data, crc);
+}
+
+static bool norflash_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+						uint8_t write_size, const uint8_t *write_data)
 {
 	uint32_t spi_ss;
-	uint32_t exp_write_disable[] = {0x00, 0x00};
+	uint8_t exp_write_disable[] = {0x00, 0x00};
 
 	if (mem_no > 1) {
 		debug("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
@@ -681,21 +1545,25 @@ bool qspi_norflash_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
 	}
 
 	debug("* [#2] Set to `Write Enable'\n");
-	if (!set_write_enable(base, spi_ss)) {
+	if (!qspi_ctrl_set_write_enable(base, spi_ss, true)) {
 		assert();
 		return false;
 	}
 
 	debug("* [#3] Write Data (QUAD Mode)\n");
-	if (!qspi_memory_data_quad_write(base, spi_ss, mem_addr, write_size, write_data)) {
+	if (!qspi_memory_data_quad_page_write(base, spi_ss, mem_addr, write_data, write_size)) {
 		assert();
 		return false;
 	}
 
-	k_usleep(10);
+	if (!wait_norflash_ready(base, spi_ss, get_norflash_dev_index(base, mem_no),
+								NORFLASH_BUSY_PROGRAM, k_cycle_get_32(), NULL)) {
+		assert();
+		return false;
+	}
 
 	debug("* [#4] Verify Status Register (WEL=0)\n");
-	if (!verify_status_resisger1(base, spi_ss, ARRAY_SIZE(exp_write_disable), exp_write_disable)) {
+	if (!qspi_ctrl_verify_status_register1(base, spi_ss, ARRAY_SIZE(exp_write_disable), exp_write_disable)) {
 		assert();
 		return false;
 	}
@@ -703,12 +1571,27 @@ bool qspi_norflash_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
 	return true;
 }
 
-bool qspi_norflash_multi_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val)
+bool qspi_norflash_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+						uint8_t write_size, const uint8_t *write_data)
+{
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_write(base, mem_no, mem_addr, write_size, write_data);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+static bool norflash_multi_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val)
 {
 	uint32_t spi_ss;
-	uint32_t write_data[QSPI_RX_FIFO_MAX_BYTE];
-	uint32_t exp_write_disable[] = {0x00, 0x00};
-	uint16_t loop_count;
+	uint8_t page_data[QSPI_NOR_FLASH_PAGE_BYTE];
+	uint32_t total_size = size;
+	uint32_t page_size;
+	uint32_t write_size;
+	uint32_t start_cycle;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
 
 	if (mem_no > 1) {
 		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
@@ -725,57 +1608,173 @@ bool qspi_norflash_multi_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
 		return false;
 	}
 
-	loop_count = size/QSPI_RX_FIFO_MAX_BYTE;
-	for (uint16_t i=0; i<loop_count; i++) {
+	page_size = get_norflash_params(dev)->page_size;
+	start_cycle = k_cycle_get_32();
+	while (size > 0) {
+		write_size = MIN(size, page_size - (mem_addr % page_size));
+		start_val = qspi_create_fifo_data(start_val, page_data, write_size, false);
 
-		debug("* [#2] Set to `Write Enable'\n");
-		if (!set_write_enable(base, spi_ss)) {
+		debug("* [#2] Page Program (QUAD Mode)\n");
+		if (!qspi_norflash_page_program(base, spi_ss, dev, mem_addr, page_data, write_size)) {
 			assert();
 			return false;
 		}
+		mem_addr += write_size;
+		size -= write_size;
+	}
 
-		debug("* [#3] Write Data (QUAD Mode)\n");
-		start_val = qspi_create_fifo_data(start_val, write_data, QSPI_RX_FIFO_MAX_BYTE, false);
-		if (!qspi_memory_data_quad_write(base, spi_ss, mem_addr, QSPI_RX_FIFO_MAX_BYTE, write_data)) {
-			assert();
-			return false;
-		}
-		mem_addr += QSPI_RX_FIFO_MAX_BYTE;
+	qspi_print_throughput("NOR flash program", total_size, get_elapsed_us(start_cycle));
 
-		k_usleep(10);
+	return true;
+}
 
-		debug("* [#4] Verify Status Register (WEL=0)\n");
-		if (!verify_status_resisger1(base, spi_ss, ARRAY_SIZE(exp_write_disable), exp_write_disable)) {
-			assert();
+bool qspi_norflash_multi_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size, uint8_t start_val)
+{
+	bool ret;
+
+	qspi_ctrl_lock(base);
+	ret = norflash_multi_write(base, mem_no, mem_addr, size, start_val);
+	qspi_ctrl_unlock(base);
+
+	return ret;
+}
+
+/*
+ * Program `size` byte from `mem_addr` page by page, and wait for the
+ * completion of each page. Write Enable Latch is verified before each
+ * page, and Status Register 1 (no WIP, no error) after it. The range
+ * must be erased.
+ */
+static bool norflash_write_buf(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+								const uint8_t *buf, uint32_t size)
+{
+	uint32_t spi_ss;
+	uint8_t dev = get_norflash_dev_index(base, mem_no);
+	uint32_t page_size;
+	uint32_t write_size;
+
+	if (mem_no > 1) {
+		err("Invalid Mem number %d (expected 0 or 1)\n", mem_no);
+		return false;
+	}
+
+	if (!qspi_select_mem(base, mem_no, &spi_ss)) {
+		return false;
+	}
+
+	page_size = get_norflash_params(dev)->page_size;
+	while (size > 0) {
+		write_size = MIN(size, page_size - (mem_addr % page_size));
+
+		if (!qspi_norflash_page_program(base, spi_ss, dev, mem_addr, buf, write_size)) {
+			err("  !!! NOR flash [%d] program failed at 0x%08x\n", dev, mem_addr);
 			return false;
 		}
+
+		mem_addr += write_size;
+		buf += write_size;
+		size -= write_size;
 	}
 
 	return true;
 }
 
-uint32_t qspi_norflash_initialize(uint32_t test_no)
+bool qspi_norflash_write_buf(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+								const uint8_t *buf, uint32_t size)
 {
-	uint32_t err_cnt = 0;
+	bool ret;
 
-	info("* [%d-1] Start QSPI Config Memory [0]: Initialize\n", test_no);
-	if (!qspi_norflash_init(SCOBCA1_FPGA_CFG_BASE_ADDR, QSPI_DATA_MEM0)) {
-		err_cnt++;
-	}
+	qspi_ctrl_lock(base);
+	ret = norflash_write_buf(base, mem_no, mem_addr, buf, size);
+	qspi_ctrl_unlock(base);
 
-	info("* [%d-2] Start QSPI Config Memory [1]: Initialize\n", test_no);
-	if (!qspi_norflash_init(SCOBCA1_FPGA_CFG_BASE_ADDR, QSPI_DATA_MEM1)) {
-		err_cnt++;
+	return ret;
+}
+
+const struct qspi_mem_ops qspi_norflash_ops = {
+	.read = qspi_norflash_read_buf,
+	.read_stream = qspi_norflash_read_stream,
+};
+
+/*
+ * Start the initialization of Config Memory 0/1 and Data Memory 0/1.
+ * The register writes run on all memories at the same time, and are
+ * completed by qspi_norflash_initialize_finish(), which also counts the
+ * memories failed here.
+ */
+void qspi_norflash_initialize_start(uint32_t test_no)
+{
+	struct norflash_init_state *state;
+
+	for (uint8_t dev=0; dev<QSPI_NOR_FLASH_DEV_NUM; dev++) {
+		state = &norflash_init_state[dev];
+		info("* [%d-%d] Start QSPI %s: Initialize\n", test_no, dev + 1, norflash_dev_name[dev]);
+
+		state->start_cycle = k_cycle_get_32();
+		state->init_us = 0;
+		qspi_ctrl_lock(get_norflash_base(dev));
+		state->is_ok = start_norflash_init(get_norflash_base(dev), dev % 2,
+											&state->is_busy);
+		qspi_ctrl_unlock(get_norflash_base(dev));
+		if (!state->is_ok) {
+			state->is_busy = false;
+			continue;
+		}
+		if (!state->is_busy) {
+			state->init_us = get_elapsed_us(state->start_cycle);
+		}
 	}
+}
 
-	info("* [%d-3] Start QSPI Data Memory [0]: Initialize\n", test_no);
-	if (!qspi_norflash_init(SCOBCA1_FPGA_DATA_BASE_ADDR, QSPI_DATA_MEM0)) {
-		err_cnt++;
+/* Poll all memories until the register writes are completed */
+uint32_t qspi_norflash_initialize_finish(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	struct norflash_init_state *state;
+	bool is_busy = true;
+	bool is_ready;
+	bool ret;
+
+	ARG_UNUSED(test_no);
+
+	while (is_busy) {
+		is_busy = false;
+		for (uint8_t dev=0; dev<QSPI_NOR_FLASH_DEV_NUM; dev++) {
+			state = &norflash_init_state[dev];
+			if (!state->is_busy) {
+				continue;
+			}
+
+			qspi_ctrl_lock(get_norflash_base(dev));
+			ret = poll_norflash_init(get_norflash_base(dev), dev % 2,
+										state->start_cycle, &is_ready);
+			qspi_ctrl_unlock(get_norflash_base(dev));
+			if (!ret) {
+				state->is_ok = false;
+				state->is_busy = false;
+				continue;
+			}
+			if (is_ready) {
+				state->init_us = get_elapsed_us(state->start_cycle);
+				state->is_busy = false;
+				continue;
+			}
+			is_busy = true;
+		}
+		if (is_busy) {
+			k_usleep(QSPI_NOR_FLASH_INIT_POLL_US);
+		}
 	}
 
-	info("* [%d-4] Start QSPI Data Memory [1]: Initialize\n", test_no);
-	if (!qspi_norflash_init(SCOBCA1_FPGA_DATA_BASE_ADDR, QSPI_DATA_MEM1)) {
-		err_cnt++;
+	for (uint8_t dev=0; dev<QSPI_NOR_FLASH_DEV_NUM; dev++) {
+		state = &norflash_init_state[dev];
+		if (!state->is_ok) {
+			err("  !!! %s: Initialize failed\n", norflash_dev_name[dev]);
+			err_cnt++;
+			continue;
+		}
+		info("* %s: Initialized (%d us)\n", norflash_dev_name[dev], state->init_us);
+		qspi_mem_params_print(norflash_dev_name[dev], get_norflash_params(dev));
 	}
 
 	return err_cnt;
@@ -794,9 +1793,9 @@ uint32_t qspi_norflash_initialize(uint32_t test_no)
 static uint32_t qspi_norflash_test(uint32_t test_no, uint32_t base)
 {
 	uint32_t err_cnt = 0;
-	uint32_t exp_init_data[QSPI_RX_FIFO_MAX_BYTE];
-	uint32_t write_data_0[QSPI_RX_FIFO_MAX_BYTE];
-	uint32_t write_data_1[QSPI_RX_FIFO_MAX_BYTE];
+	uint8_t exp_init_data[QSPI_RX_FIFO_MAX_BYTE];
+	uint8_t write_data_0[QSPI_RX_FIFO_MAX_BYTE];
+	uint8_t write_data_1[QSPI_RX_FIFO_MAX_BYTE];
 	uint32_t mem_addr_0 = 0x00800000;
 	uint32_t mem_addr_1 = 0x00900000;
 	uint8_t start_val_0 = 0x00;
@@ -812,14 +1811,14 @@ static uint32_t qspi_norflash_test(uint32_t test_no, uint32_t base)
 
 	info("* [%d-1] Start QSPI Memory [0]: Erase Test (Sector)\n", test_no);
 	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_SECTOR,
-							mem_addr_0, is_wait_idle)) {
+							mem_addr_0, is_wait_idle, NULL)) {
 		err_cnt++;
 		goto end_of_test;
 	}
 
 	info("* [%d-2] Start QSPI Memory [1]: Erase Test (Sector)\n", test_no);
 	if (!qspi_norflash_erase(base, QSPI_DATA_MEM1, QSPI_ERASE_SECTOR,
-							mem_addr_1, is_wait_idle)) {
+							mem_addr_1, is_wait_idle, NULL)) {
 		err_cnt++;
 		goto end_of_test;
 	}
@@ -870,11 +1869,28 @@ end_of_test:
 	return err_cnt;
 }
 
+static bool blank_check_memory(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size)
+{
+	bool is_blank;
+	uint32_t fail_addr;
+
+	if (!qspi_norflash_blank_check(base, mem_no, mem_addr, size, &is_blank, &fail_addr)) {
+		return false;
+	}
+
+	if (!is_blank) {
+		err("  !!! Assertion failed: not blank at 0x%08x\n", fail_addr);
+		return false;
+	}
+
+	return true;
+}
+
 /*
  *   1. Erase Memory 0 (Sector)
  *   2. Erase Memory 1 (Sector)
- *   3. Read Memory 0  (all 0xFF)
- *   4. Read Memory 1  (all 0xFF)
+ *   3. Blank Check Memory 0
+ *   4. Blank Check Memory 1
  *   5. Write Memory 0 (Sector:4KB)
  *   6. Write Memory 1 (Sector:4KB)
  *   7. Read Memory 0
@@ -887,35 +1903,36 @@ static uint32_t qspi_norflash_sector_test(uint32_t test_no, uint32_t base)
 	uint32_t mem_addr_1 = 0x00900000;
 	uint8_t start_val_0 = 0x00;
 	uint8_t start_val_1 = 0x10;
+	uint32_t erase_time_us;
 	bool is_wait_idle = true;
 
 	info("* [%d-1] Start QSPI Memory [0]: Erase Test (Sector)\n", test_no);
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_SECTOR, mem_addr_0, is_wait_idle)) {
+	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_SECTOR, mem_addr_0,
+								is_wait_idle, &erase_time_us)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
 	}
+	info("* [%d-1] Erase time: %d us\n", test_no, erase_time_us);
 
 	info("* [%d-2] Start QSPI Memory [1]: Erase Test (Sector)\n", test_no);
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM1, QSPI_ERASE_SECTOR, mem_addr_1, is_wait_idle)) {
+	if (!qspi_norflash_erase(base, QSPI_DATA_MEM1, QSPI_ERASE_SECTOR, mem_addr_1,
+								is_wait_idle, &erase_time_us)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
 	}
+	info("* [%d-2] Erase time: %d us\n", test_no, erase_time_us);
 
-	info("* [%d-3] Start QSPI Memory [0]: Read initial data Test (Sector:4KB)\n", test_no);
-	is_wait_idle = true;
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM0, mem_addr_0,
-								QSPI_NOR_FLASH_SECTOR_BYTE, start_val_0, true)) {
+	info("* [%d-3] Start QSPI Memory [0]: Blank Check Test (Sector:4KB)\n", test_no);
+	if (!blank_check_memory(base, QSPI_DATA_MEM0, mem_addr_0, QSPI_NOR_FLASH_SECTOR_BYTE)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
 	}
 
-	info("* [%d-4] Start QSPI Memory [1]: Read initial data Test (Sector:4KB)\n", test_no);
-	is_wait_idle = true;
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM1, mem_addr_1,
-								QSPI_NOR_FLASH_SECTOR_BYTE, start_val_1, true)) {
+	info("* [%d-4] Start QSPI Memory [1]: Blank Check Test (Sector:4KB)\n", test_no);
+	if (!blank_check_memory(base, QSPI_DATA_MEM1, mem_addr_1, QSPI_NOR_FLASH_SECTOR_BYTE)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
@@ -960,8 +1977,8 @@ end_of_test:
 /*
  *   1. Erase Memory 0 (Sector)
  *   2. Erase Memory 1 (Sector)
- *   3. Read Memory 0  (all 0xFF)
- *   4. Read Memory 1  (all 0xFF)
+ *   3. Blank Check Memory 0
+ *   4. Blank Check Memory 1
  *   5. Write Memory 0 (Block:64KB)
  *   6. Write Memory 1 (Block:64KB)
  *   7. Read Memory 0
@@ -974,35 +1991,36 @@ static uint32_t qspi_norflash_block_test(uint32_t test_no, uint32_t base)
 	uint32_t mem_addr_1 = 0x00B00000;
 	uint8_t start_val_0 = 0x60;
 	uint8_t start_val_1 = 0x70;
+	uint32_t erase_time_us;
 	bool is_wait_idle = true;
 
 	info("* [%d-1] Start QSPI Memory [0]: Erase Test (Block)\n", test_no);
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_BLOCK, mem_addr_0, is_wait_idle)) {
+	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_BLOCK, mem_addr_0,
+								is_wait_idle, &erase_time_us)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
 	}
+	info("* [%d-1] Erase time: %d us\n", test_no, erase_time_us);
 
 	info("* [%d-2] Start QSPI Memory [1]: Erase Test (Block)\n", test_no);
-	if (!qspi_norflash_erase(base, QSPI_DATA_MEM1, QSPI_ERASE_BLOCK, mem_addr_1, is_wait_idle)) {
+	if (!qspi_norflash_erase(base, QSPI_DATA_MEM1, QSPI_ERASE_BLOCK, mem_addr_1,
+								is_wait_idle, &erase_time_us)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
 	}
+	info("* [%d-2] Erase time: %d us\n", test_no, erase_time_us);
 
-	info("* [%d-3] Start QSPI Memory [0]: Read initial data Test (Block:64KB)\n", test_no);
-	is_wait_idle = true;
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM0, mem_addr_0,
-								QSPI_NOR_FLASH_BLOCK_BYTE, start_val_0, true)) {
+	info("* [%d-3] Start QSPI Memory [0]: Blank Check Test (Block:64KB)\n", test_no);
+	if (!blank_check_memory(base, QSPI_DATA_MEM0, mem_addr_0, QSPI_NOR_FLASH_BLOCK_BYTE)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
 	}
 
-	info("* [%d-4] Start QSPI Memory [1]: Read initial data Test (Block:64KB)\n", test_no);
-	is_wait_idle = true;
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM1, mem_addr_1,
-								QSPI_NOR_FLASH_BLOCK_BYTE, start_val_1, true)) {
+	info("* [%d-4] Start QSPI Memory [1]: Blank Check Test (Block:64KB)\n", test_no);
+	if (!blank_check_memory(base, QSPI_DATA_MEM1, mem_addr_1, QSPI_NOR_FLASH_BLOCK_BYTE)) {
 		assert();
 		err_cnt++;
 		goto end_of_test;
@@ -1025,14 +2043,14 @@ static uint32_t qspi_norflash_block_test(uint32_t test_no, uint32_t base)
 	}
 
 	info("* [%d-7] Start QSPI Memory [0]: Read data Test (Block:64KB)\n", test_no);
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM0, mem_addr_0,
+	if (!qspi_norflash_bulk_read(base, QSPI_DATA_MEM0, mem_addr_0,
 								QSPI_NOR_FLASH_BLOCK_BYTE, start_val_0, false)) {
 		assert();
 		err_cnt++;
 	}
 
 	info("* [%d-8] Start QSPI Memory [1]: Read data Test (Block:64KB)\n", test_no);
-	if (!qspi_norflash_multi_read(base, QSPI_DATA_MEM1, mem_addr_1,
+	if (!qspi_norflash_bulk_read(base, QSPI_DATA_MEM1, mem_addr_1,
 								QSPI_NOR_FLASH_BLOCK_BYTE, start_val_1, false)) {
 		assert();
 		err_cnt++;
@@ -1087,7 +2105,7 @@ static bool qspi_config_memory_switch_memsel(uint32_t test_no)
 		subno++;
 
 		info("* [%d-%d] Active SPI SS\n", test_no, subno);
-		if (!activate_spi_ss(base, spi_ss)) {
+		if (!qspi_ctrl_activate(base, spi_ss)) {
 			assert();
 			return false;
 		}
@@ -1102,7 +2120,7 @@ static bool qspi_config_memory_switch_memsel(uint32_t test_no)
 		subno++;
 
 		info("* [%d-%d] Inactive SPI SS\n", test_no, subno);
-		if (!inactivate_spi_ss(base)) {
+		if (!qspi_ctrl_inactivate(base)) {
 			assert();
 			return false;
 		}
@@ -1215,10 +2233,155 @@ uint32_t qspi_config_memory_trch_moni_test(uint32_t test_no)
 
 	info("* [%d] Start Config Memory TRCH_CFG_MEM_MONI Test\n", test_no);
 
+	qspi_ctrl_lock(SCOBCA1_FPGA_CFG_BASE_ADDR);
 	if (!qspi_config_memory_switch_memsel(test_no)) {
 		err_cnt++;
 	}
+	qspi_ctrl_unlock(SCOBCA1_FPGA_CFG_BASE_ADDR);
+
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
+
+/*
+ * Blank Check the whole Config Memory 0/1 and Data Memory 0/1. A memory
+ * which is not blank is reported with the first non-blank address, but
+ * it is not an error.
+ */
+uint32_t qspi_norflash_blank_check_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint8_t mem_no;
+	uint32_t size;
+	uint32_t fail_addr;
+	bool is_blank;
+
+	info("* [%d] Start QSPI NOR Flash Blank Check\n", test_no);
+
+	for (uint8_t dev=0; dev<QSPI_NOR_FLASH_DEV_NUM; dev++) {
+		mem_no = dev % 2;
+		size = get_norflash_params(dev)->size;
+
+		info("* [%d-%d] Start QSPI %s: Blank Check (%d byte)\n", test_no, dev + 1,
+				norflash_dev_name[dev], size);
+		if (!qspi_norflash_blank_check(get_norflash_base(dev), mem_no, 0, size, &is_blank,
+										&fail_addr)) {
+			assert();
+			err_cnt++;
+			continue;
+		}
+
+		if (is_blank) {
+			info("  Blank\n");
+		} else {
+			info("  Not blank at 0x%08x\n", fail_addr);
+		}
+	}
+
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
+
+static void print_norflash_timing(const char *name, const struct norflash_busy_timing *timing)
+{
+	if (timing->count == 0) {
+		info("  %s: -\n", name);
+		return;
+	}
+
+	info("  %s: %d times, min %d us, max %d us\n", name, timing->count,
+			timing->min_us, timing->max_us);
+}
+
+/*
+ *   1. Write Data Memory 0 (Page:256 byte) as the read data
+ *   2. Start Block Erase on Data Memory 0 (without waiting)
+ *   3. Read the page while the Block Erase is in progress
+ *      (the Erase is suspended and resumed on each read)
+ *   4. Blank Check the erased Block
+ */
+uint32_t qspi_data_memory_erase_suspend_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t base = SCOBCA1_FPGA_DATA_BASE_ADDR;
+	uint8_t dev = get_norflash_dev_index(base, QSPI_DATA_MEM0);
+	uint32_t read_addr = 0x00D80000;
+	uint32_t erase_addr = 0x00D90000;
+	uint8_t start_val = 0xA0;
+	uint8_t exp_data[QSPI_NOR_FLASH_PAGE_BYTE];
+	uint8_t read_data[QSPI_NOR_FLASH_PAGE_BYTE];
+	struct norflash_busy_timing read_timing = {0};
+	uint32_t erase_cycle;
+	uint32_t read_cycle;
+	bool is_ready = false;
+	bool is_blank;
+	uint32_t fail_addr;
+
+	info("* [%d] Start QSPI Data Memory Erase Suspend Test\n", test_no);
+
+	info("* [%d-1] Start QSPI Data Memory [0]: Write read data (Page:256 byte)\n", test_no);
+	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_SECTOR, read_addr, true, NULL) ||
+			!qspi_norflash_multi_write(base, QSPI_DATA_MEM0, read_addr,
+										QSPI_NOR_FLASH_PAGE_BYTE, start_val)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	qspi_create_fifo_data(start_val, exp_data, sizeof(exp_data), false);
+
+	info("* [%d-2] Start QSPI Data Memory [0]: Block Erase (without waiting)\n", test_no);
+	norflash_suspend_timing[dev] = (struct norflash_busy_timing){0};
+	norflash_resume_timing[dev] = (struct norflash_busy_timing){0};
+	if (!qspi_norflash_erase(base, QSPI_DATA_MEM0, QSPI_ERASE_BLOCK, erase_addr, false, NULL)) {
+		assert();
+		err_cnt++;
+		goto end_of_test;
+	}
+	erase_cycle = k_cycle_get_32();
+
+	info("* [%d-3] Start QSPI Data Memory [0]: Read during Block Erase\n", test_no);
+	while (!is_ready) {
+		read_cycle = k_cycle_get_32();
+		if (!qspi_norflash_read_buf(base, QSPI_DATA_MEM0, read_addr, read_data,
+									sizeof(read_data))) {
+			assert();
+			err_cnt++;
+			goto end_of_test;
+		}
+		update_norflash_timing(&read_timing, get_elapsed_us(read_cycle));
+		if (memcmp(read_data, exp_data, sizeof(read_data)) != 0) {
+			err("  !!! Read data mismatch during Block Erase\n");
+			assert();
+			err_cnt++;
+		}
+
+		k_msleep(10);
+		if (!qspi_norflash_poll_ready(base, QSPI_DATA_MEM0, NORFLASH_BUSY_BLOCK_ERASE,
+										erase_cycle, &is_ready)) {
+			assert();
+			err_cnt++;
+			goto end_of_test;
+		}
+	}
+	info("  Block Erase: %d us (suspended: %d us)\n", get_elapsed_us(erase_cycle),
+			norflash_suspend[dev].suspended_us);
+	print_norflash_timing("Read", &read_timing);
+	print_norflash_timing("Erase Suspend", &norflash_suspend_timing[dev]);
+	print_norflash_timing("Erase Resume", &norflash_resume_timing[dev]);
+
+	info("* [%d-4] Start QSPI Data Memory [0]: Blank Check Test (Block:64KB)\n", test_no);
+	if (!qspi_norflash_blank_check(base, QSPI_DATA_MEM0, erase_addr, QSPI_NOR_FLASH_BLOCK_BYTE,
+									&is_blank, &fail_addr)) {
+		assert();
+		err_cnt++;
+	} else if (!is_blank) {
+		err("  !!! Assertion failed: not blank at 0x%08x\n", fail_addr);
+		err_cnt++;
+	}
 
+end_of_test:
 	print_result(test_no, err_cnt);
 
 	return err_cnt;
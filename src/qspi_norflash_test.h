@@ -9,20 +9,60 @@
 
 #include <zephyr/kernel.h>
 #include "qspi_common.h"
+#include "qspi_sfdp.h"
+#include "qspi_ctrl.h"
 
-uint32_t qspi_norflash_initialize(uint32_t test_no);
+/* Config Memory 0/1 and Data Memory 0/1 */
+#define QSPI_NOR_FLASH_DEV_NUM (4u)
+
+enum NorflashBusyOp
+{
+	NORFLASH_BUSY_SECTOR_ERASE = QSPI_ERASE_SECTOR,
+	NORFLASH_BUSY_HALF_BLOCK_ERASE = QSPI_ERASE_HALF_BLOCK,
+	NORFLASH_BUSY_BLOCK_ERASE = QSPI_ERASE_BLOCK,
+	NORFLASH_BUSY_PROGRAM,
+	NORFLASH_BUSY_OP_NUM,
+};
+
+extern const struct qspi_mem_ops qspi_norflash_ops;
+
+bool qspi_norflash_init(uint32_t base, uint8_t mem_no);
+const struct qspi_mem_params *qspi_norflash_get_params(uint32_t base, uint8_t mem_no);
+const char *qspi_norflash_get_dev_name(uint8_t dev);
+void qspi_norflash_initialize_start(uint32_t test_no);
+uint32_t qspi_norflash_initialize_finish(uint32_t test_no);
 uint32_t qspi_config_memory_test(uint32_t test_no);
 uint32_t qspi_config_memory_sector_test(uint32_t test_no);
 uint32_t qspi_config_memory_block_test(uint32_t test_no);
 uint32_t qspi_config_memory_trch_moni_test(uint32_t test_no);
+uint32_t qspi_norflash_blank_check_test(uint32_t test_no);
+uint32_t qspi_data_memory_erase_suspend_test(uint32_t test_no);
 uint32_t qspi_data_memory_test(uint32_t test_no);
 uint32_t qspi_data_memory_sector_test(uint32_t test_no);
 uint32_t qspi_data_memory_block_test(uint32_t test_no);
 bool qspi_norflash_erase(uint32_t base, uint8_t mem_no, enum QspiEraseType type,
-								uint32_t mem_addr, bool is_wait_idle);
+								uint32_t mem_addr, bool is_wait_idle, uint32_t *erase_time_us);
 bool qspi_norflash_multi_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
 							uint32_t size, uint8_t start_val, bool is_init);
+bool qspi_norflash_bulk_read(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+							uint32_t size, uint8_t start_val, bool is_init);
+bool qspi_norflash_read_stream(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								qspi_read_sink_t sink, void *arg);
+bool qspi_norflash_read_buf(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint8_t *buf,
+							uint32_t size);
+bool qspi_norflash_blank_check(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+								bool *is_blank, uint32_t *fail_addr);
+bool qspi_norflash_read_crc(uint32_t base, uint8_t mem_no, uint32_t mem_addr, uint32_t size,
+							uint32_t *crc);
+bool qspi_norflash_write_buf(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+								const uint8_t *buf, uint32_t size);
 bool qspi_norflash_multi_write(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
 							uint32_t size, uint8_t start_val);
+bool qspi_norflash_page_program_start(uint32_t base, uint8_t mem_no, uint32_t mem_addr,
+									const uint8_t *write_data, size_t write_size);
+bool qspi_norflash_poll_ready(uint32_t base, uint8_t mem_no, enum NorflashBusyOp op,
+								uint32_t start_cycle, bool *is_ready);
+bool qspi_norflash_wait_ready(uint32_t base, uint8_t mem_no, enum NorflashBusyOp op,
+								uint32_t start_cycle);
 
 #endif /* SCOBCA1_FPGA_TEST_QSPI_NORFLASH_TESET_H_ */
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/crc.h>
+#include <string.h>
+#include "qspi_norflash_wear.h"
+#include "qspi_fram_test.h"
+#include "common.h"
+
+#define QSPI_NOR_FLASH_WEAR_RECORD_MAGIC (0x52455751)   /* "QWER" */
+/* The average of the first completions is the baseline of the drift */
+#define QSPI_NOR_FLASH_WEAR_BASELINE_COUNT (16u)
+/* Weight of the recent busy time (1/8) */
+#define QSPI_NOR_FLASH_WEAR_RECENT_SHIFT (3u)
+#define QSPI_NOR_FLASH_WEAR_DRIFT_PERCENT (50)
+/* The busy time seen by a poll later than this is not a measurement */
+#define QSPI_NOR_FLASH_WEAR_RESOLUTION_PERCENT (25)
+
+/* Busy time per region and operation, on each device */
+struct norflash_wear_entry {
+	uint32_t count;
+	uint32_t baseline_us;
+	uint32_t recent_us;
+	uint16_t hist[QSPI_NOR_FLASH_WEAR_HIST_NUM];
+};
+
+/* Stored in FRAM 0 record area (1.8KB, up to the end of FRAM 0) */
+struct norflash_wear_record {
+	uint32_t magic;
+	struct norflash_wear_entry entry[QSPI_NOR_FLASH_DEV_NUM][QSPI_NOR_FLASH_WEAR_REGION_NUM]
+									[NORFLASH_BUSY_OP_NUM];
+	uint32_t crc;
+};
+
+/*
+ * Lower limit of the first histogram bin. The bin N counts the busy time
+ * from (limit << N) to (limit << (N+1)), and the last bin counts the rest.
+ */
+static const uint32_t norflash_wear_hist_base_us[NORFLASH_BUSY_OP_NUM] = {
+	[NORFLASH_BUSY_SECTOR_ERASE] = 8000,
+	[NORFLASH_BUSY_HALF_BLOCK_ERASE] = 16000,
+	[NORFLASH_BUSY_BLOCK_ERASE] = 32000,
+	[NORFLASH_BUSY_PROGRAM] = 32,
+};
+
+static const char *norflash_wear_op_name[NORFLASH_BUSY_OP_NUM] = {
+	[NORFLASH_BUSY_SECTOR_ERASE] = "Sector Erase",
+	[NORFLASH_BUSY_HALF_BLOCK_ERASE] = "Half Block Erase",
+	[NORFLASH_BUSY_BLOCK_ERASE] = "Block Erase",
+	[NORFLASH_BUSY_PROGRAM] = "Page Program",
+};
+
+/* Updated by the async thread and the scheduler on each controller */
+static K_MUTEX_DEFINE(wear_mutex);
+static struct norflash_wear_record wear_record;
+static struct norflash_wear_record wear_read_record;
+
+static uint8_t get_wear_hist_bin(enum NorflashBusyOp op, uint32_t elapsed_us)
+{
+	uint32_t ratio = elapsed_us / norflash_wear_hist_base_us[op];
+	uint8_t bin = 0;
+
+	while (ratio > 1 && bin < QSPI_NOR_FLASH_WEAR_HIST_NUM - 1) {
+		ratio >>= 1;
+		bin++;
+	}
+
+	return bin;
+}
+
+/* Drift (%) of the recent busy time from the baseline */
+static int32_t get_wear_drift(const struct norflash_wear_entry *entry)
+{
+	if (entry->count <= QSPI_NOR_FLASH_WEAR_BASELINE_COUNT || entry->baseline_us == 0) {
+		return 0;
+	}
+
+	return ((int64_t)entry->recent_us - entry->baseline_us) * 100 / entry->baseline_us;
+}
+
+static bool is_wear_drifted(const struct norflash_wear_entry *entry)
+{
+	return get_wear_drift(entry) > QSPI_NOR_FLASH_WEAR_DRIFT_PERCENT;
+}
+
+/*
+ * Add the busy time of the Erase or Program completed at `mem_addr`.
+ * The recent busy time is the average until the baseline is fixed, and
+ * then the moving average. The sample is dropped when the polling
+ * resolution (e.g. the round-robin latency of the scheduler) is too
+ * large for the busy time.
+ */
+void qspi_norflash_wear_update(uint8_t dev, enum NorflashBusyOp op, uint32_t mem_addr,
+								uint32_t elapsed_us, uint32_t resolution_us)
+{
+	uint32_t region = mem_addr / QSPI_NOR_FLASH_WEAR_REGION_BYTE;
+	struct norflash_wear_entry *entry;
+	uint8_t bin;
+
+	if (dev >= QSPI_NOR_FLASH_DEV_NUM || op >= NORFLASH_BUSY_OP_NUM ||
+			region >= QSPI_NOR_FLASH_WEAR_REGION_NUM) {
+		return;
+	}
+
+	if ((uint64_t)resolution_us * 100 >
+			(uint64_t)elapsed_us * QSPI_NOR_FLASH_WEAR_RESOLUTION_PERCENT) {
+		debug("* %s %s is not measured (%d us, polling resolution %d us)\n",
+				qspi_norflash_get_dev_name(dev), norflash_wear_op_name[op],
+				elapsed_us, resolution_us);
+		return;
+	}
+
+	k_mutex_lock(&wear_mutex, K_FOREVER);
+	entry = &wear_record.entry[dev][region][op];
+	bin = get_wear_hist_bin(op, elapsed_us);
+	if (entry->hist[bin] < UINT16_MAX) {
+		entry->hist[bin]++;
+	}
+
+	entry->count++;
+	if (entry->count <= QSPI_NOR_FLASH_WEAR_BASELINE_COUNT) {
+		entry->recent_us = ((uint64_t)entry->recent_us * (entry->count - 1) + elapsed_us) /
+							entry->count;
+		if (entry->count == QSPI_NOR_FLASH_WEAR_BASELINE_COUNT) {
+			entry->baseline_us = entry->recent_us;
+		}
+	} else {
+		entry->recent_us = entry->recent_us - (entry->recent_us >> QSPI_NOR_FLASH_WEAR_RECENT_SHIFT) +
+							(elapsed_us >> QSPI_NOR_FLASH_WEAR_RECENT_SHIFT);
+	}
+
+	if (entry->count > QSPI_NOR_FLASH_WEAR_BASELINE_COUNT && is_wear_drifted(entry)) {
+		debug("* %s region %d %s drifted (%d us, baseline: %d us)\n",
+				qspi_norflash_get_dev_name(dev), region, norflash_wear_op_name[op],
+				entry->recent_us, entry->baseline_us);
+	}
+	k_mutex_unlock(&wear_mutex);
+}
+
+static uint32_t get_wear_record_crc(const struct norflash_wear_record *record)
+{
+	return crc32_ieee((const uint8_t *)record, offsetof(struct norflash_wear_record, crc));
+}
+
+static bool load_wear_record(void)
+{
+	if (!qspi_fram_read(0, QSPI_FRAM_WEAR_RECORD_ADDR, (uint8_t *)&wear_read_record,
+						sizeof(wear_read_record))) {
+		return false;
+	}
+
+	if (wear_read_record.magic != QSPI_NOR_FLASH_WEAR_RECORD_MAGIC ||
+			wear_read_record.crc != get_wear_record_crc(&wear_read_record)) {
+		debug("* NOR flash wear record is not found\n");
+		return false;
+	}
+
+	memcpy(&wear_record, &wear_read_record, sizeof(wear_record));
+	info("* Restore NOR flash wear record from FRAM (0x%08x)\n", QSPI_FRAM_WEAR_RECORD_ADDR);
+
+	return true;
+}
+
+static bool store_wear_record(void)
+{
+	wear_record.magic = QSPI_NOR_FLASH_WEAR_RECORD_MAGIC;
+	wear_record.crc = get_wear_record_crc(&wear_record);
+
+	if (!qspi_fram_write(0, QSPI_FRAM_WEAR_RECORD_ADDR, (const uint8_t *)&wear_record,
+							sizeof(wear_record))) {
+		return false;
+	}
+
+	if (!qspi_fram_read(0, QSPI_FRAM_WEAR_RECORD_ADDR, (uint8_t *)&wear_read_record,
+						sizeof(wear_read_record))) {
+		return false;
+	}
+
+	return memcmp(&wear_record, &wear_read_record, sizeof(wear_read_record)) == 0;
+}
+
+/* Restore the histograms stored on FRAM, if any */
+bool qspi_norflash_wear_load(void)
+{
+	bool ret;
+
+	k_mutex_lock(&wear_mutex, K_FOREVER);
+	ret = load_wear_record();
+	k_mutex_unlock(&wear_mutex);
+
+	return ret;
+}
+
+bool qspi_norflash_wear_store(void)
+{
+	bool ret;
+
+	k_mutex_lock(&wear_mutex, K_FOREVER);
+	ret = store_wear_record();
+	k_mutex_unlock(&wear_mutex);
+
+	return ret;
+}
+
+/*
+ * Print the Erase/Program cycles and the worst drift on each device.
+ * Return the number of drifted regions.
+ */
+uint32_t qspi_norflash_wear_print_trend(void)
+{
+	struct norflash_wear_entry *entry;
+	uint32_t drifted_count = 0;
+	uint32_t erase_count;
+	uint32_t program_count;
+	uint32_t drifted;
+	int32_t worst;
+	int32_t drift;
+
+	k_mutex_lock(&wear_mutex, K_FOREVER);
+	for (uint8_t dev=0; dev<QSPI_NOR_FLASH_DEV_NUM; dev++) {
+		erase_count = 0;
+		program_count = 0;
+		drifted = 0;
+		worst = 0;
+		for (uint8_t region=0; region<QSPI_NOR_FLASH_WEAR_REGION_NUM; region++) {
+			for (uint8_t op=0; op<NORFLASH_BUSY_OP_NUM; op++) {
+				entry = &wear_record.entry[dev][region][op];
+				if (op == NORFLASH_BUSY_PROGRAM) {
+					program_count += entry->count;
+				} else {
+					erase_count += entry->count;
+				}
+				drift = get_wear_drift(entry);
+				worst = MAX(worst, drift);
+				if (is_wear_drifted(entry)) {
+					drifted++;
+				}
+			}
+		}
+		info("* Wear [%s] erase:%d program:%d worst drift:%d%% drifted:%d\n",
+				qspi_norflash_get_dev_name(dev), erase_count, program_count, worst, drifted);
+		drifted_count += drifted;
+	}
+	k_mutex_unlock(&wear_mutex);
+
+	return drifted_count;
+}
+
+static void print_wear_entry(uint8_t dev, uint8_t region, uint8_t op)
+{
+	struct norflash_wear_entry *entry = &wear_record.entry[dev][region][op];
+
+	info("  %-15s %d %-16s %8d %8d %8d %4d%% %c |", qspi_norflash_get_dev_name(dev), region,
+			norflash_wear_op_name[op], entry->count, entry->baseline_us, entry->recent_us,
+			get_wear_drift(entry), is_wear_drifted(entry) ? '!' : ' ');
+	for (uint8_t i=0; i<QSPI_NOR_FLASH_WEAR_HIST_NUM; i++) {
+		info(" %5d", entry->hist[i]);
+	}
+	info("\n");
+}
+
+/*
+ *   1. Print the histograms of the busy time on each region
+ *   2. Store the histograms to FRAM record area
+ */
+uint32_t qspi_norflash_wear_test(uint32_t test_no)
+{
+	uint32_t err_cnt = 0;
+	uint32_t drifted_count;
+
+	info("* [%d] Start QSPI NOR Flash Wear Trend\n", test_no);
+
+	info("* [%d-1] Print the busy time histograms (region: %dMB, drift threshold: %d%%)\n",
+			test_no, QSPI_NOR_FLASH_WEAR_REGION_BYTE / 1024 / 1024,
+			QSPI_NOR_FLASH_WEAR_DRIFT_PERCENT);
+	info("  %-15s R %-16s %8s %8s %8s %5s   | histogram (x1, x2, x4, ...)\n",
+			"Device", "Operation", "Count", "Base(us)", "Rcnt(us)", "Drift");
+	k_mutex_lock(&wear_mutex, K_FOREVER);
+	for (uint8_t dev=0; dev<QSPI_NOR_FLASH_DEV_NUM; dev++) {
+		for (uint8_t region=0; region<QSPI_NOR_FLASH_WEAR_REGION_NUM; region++) {
+			for (uint8_t op=0; op<NORFLASH_BUSY_OP_NUM; op++) {
+				if (wear_record.entry[dev][region][op].count > 0) {
+					print_wear_entry(dev, region, op);
+				}
+			}
+		}
+	}
+	k_mutex_unlock(&wear_mutex);
+	drifted_count = qspi_norflash_wear_print_trend();
+	if (drifted_count > 0) {
+		info("* %d region is drifted\n", drifted_count);
+	}
+
+	info("* [%d-2] Store the histograms to FRAM (0x%08x)\n", test_no, QSPI_FRAM_WEAR_RECORD_ADDR);
+	if (!qspi_norflash_wear_store()) {
+		assert();
+		err_cnt++;
+	}
+
+	print_result(test_no, err_cnt);
+
+	return err_cnt;
+}
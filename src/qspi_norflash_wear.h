@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_NORFLASH_WEAR_H_
+#define SCOBCA1_FPGA_TEST_QSPI_NORFLASH_WEAR_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_norflash_test.h"
+
+#define QSPI_NOR_FLASH_WEAR_REGION_BYTE (4*1024*1024)
+#define QSPI_NOR_FLASH_WEAR_REGION_NUM  (4u)
+#define QSPI_NOR_FLASH_WEAR_HIST_NUM    (8u)
+
+void qspi_norflash_wear_update(uint8_t dev, enum NorflashBusyOp op, uint32_t mem_addr,
+								uint32_t elapsed_us, uint32_t resolution_us);
+bool qspi_norflash_wear_load(void);
+bool qspi_norflash_wear_store(void);
+uint32_t qspi_norflash_wear_print_trend(void);
+uint32_t qspi_norflash_wear_test(uint32_t test_no);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_NORFLASH_WEAR_H_ */
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "qspi_sfdp.h"
+#include "common.h"
+
+#define SFDP_SIGNATURE (0x50444653)   /* "SFDP" */
+#define SFDP_HEADER_BYTE (8u)
+#define SFDP_PARAM_HEADER_BYTE (8u)
+#define SFDP_BFPT_ID (0xFF00)         /* JEDEC Basic Flash Parameter Table */
+#define SFDP_BFPT_DWORD_MAX (16u)
+
+/* BFPT DWORD number (1 origin, as JESD216) */
+#define BFPT_DW_FAST_READ   (1u)
+#define BFPT_DW_DENSITY     (2u)
+#define BFPT_DW_QUAD_READ   (3u)
+#define BFPT_DW_ERASE_1_2   (8u)
+#define BFPT_DW_ERASE_3_4   (9u)
+#define BFPT_DW_PAGE        (11u)
+#define BFPT_DW_QUAD_ENABLE (15u)
+
+#define BFPT_FAST_READ_1_4_4 BIT(21)
+#define BFPT_FAST_READ_1_1_4 BIT(22)
+
+static uint32_t get_le32(const uint8_t *data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static uint32_t get_bfpt_dword(const uint8_t *bfpt, uint8_t dw)
+{
+	return get_le32(&bfpt[(dw - 1) * sizeof(uint32_t)]);
+}
+
+static void set_erase_opcode(struct qspi_mem_params *params, uint8_t size_exp, uint8_t opcode)
+{
+	if (size_exp == 0) {
+		return;
+	}
+
+	switch (BIT(size_exp)) {
+	case QSPI_NOR_FLASH_SECTOR_BYTE:
+		params->erase_opcode[QSPI_ERASE_SECTOR] = opcode;
+		break;
+	case QSPI_NOR_FLASH_BLOCK_BYTE / 2:
+		params->erase_opcode[QSPI_ERASE_HALF_BLOCK] = opcode;
+		break;
+	case QSPI_NOR_FLASH_BLOCK_BYTE:
+		params->erase_opcode[QSPI_ERASE_BLOCK] = opcode;
+		break;
+	default:
+		break;
+	}
+}
+
+static void parse_bfpt(const uint8_t *bfpt, uint8_t dw_num, struct qspi_mem_params *params)
+{
+	uint32_t dw;
+
+	/* Density: bit 31 is set for 2^N bit, otherwise (size - 1) in bit */
+	dw = get_bfpt_dword(bfpt, BFPT_DW_DENSITY);
+	if (dw & BIT(31)) {
+		params->size = BIT((dw & 0x7FFFFFFF) - 3);
+	} else {
+		params->size = (dw + 1) / 8;
+	}
+
+	/* Fastest Quad Read: 1-4-4 is prior to 1-1-4 */
+	dw = get_bfpt_dword(bfpt, BFPT_DW_FAST_READ);
+	if (dw & BFPT_FAST_READ_1_4_4) {
+		params->read_mode = QSPI_READ_MODE_1_4_4;
+		dw = get_bfpt_dword(bfpt, BFPT_DW_QUAD_READ);
+		params->read_dummy_clocks = dw & 0x1F;
+		params->read_mode_clocks = (dw >> 5) & 0x07;
+		params->read_opcode = (dw >> 8) & 0xFF;
+	} else if (dw & BFPT_FAST_READ_1_1_4) {
+		params->read_mode = QSPI_READ_MODE_1_1_4;
+		dw = get_bfpt_dword(bfpt, BFPT_DW_QUAD_READ);
+		params->read_dummy_clocks = (dw >> 16) & 0x1F;
+		params->read_mode_clocks = (dw >> 21) & 0x07;
+		params->read_opcode = (dw >> 24) & 0xFF;
+	}
+
+	/* Erase Types (JESD216 Rev.A or later), otherwise 4KB Erase only */
+	if (dw_num >= BFPT_DW_ERASE_3_4) {
+		for (uint8_t i=0; i<QSPI_ERASE_TYPE_NUM; i++) {
+			params->erase_opcode[i] = 0x00;
+		}
+		dw = get_bfpt_dword(bfpt, BFPT_DW_ERASE_1_2);
+		set_erase_opcode(params, dw & 0xFF, (dw >> 8) & 0xFF);
+		set_erase_opcode(params, (dw >> 16) & 0xFF, (dw >> 24) & 0xFF);
+		dw = get_bfpt_dword(bfpt, BFPT_DW_ERASE_3_4);
+		set_erase_opcode(params, dw & 0xFF, (dw >> 8) & 0xFF);
+		set_erase_opcode(params, (dw >> 16) & 0xFF, (dw >> 24) & 0xFF);
+	} else {
+		dw = get_bfpt_dword(bfpt, BFPT_DW_FAST_READ);
+		if ((dw & 0x03) == 0x01) {
+			params->erase_opcode[QSPI_ERASE_SECTOR] = (dw >> 8) & 0xFF;
+		}
+	}
+
+	if (dw_num >= BFPT_DW_PAGE) {
+		dw = get_bfpt_dword(bfpt, BFPT_DW_PAGE);
+		params->page_size = BIT((dw >> 4) & 0x0F);
+	}
+
+	if (dw_num >= BFPT_DW_QUAD_ENABLE) {
+		dw = get_bfpt_dword(bfpt, BFPT_DW_QUAD_ENABLE);
+		switch ((dw >> 20) & 0x07) {
+		case 0:
+			params->quad_enable = QSPI_QE_NONE;
+			break;
+		case 2:
+			params->quad_enable = QSPI_QE_SR1_BIT6;
+			break;
+		case 1:
+		case 4:
+		case 5:
+			params->quad_enable = QSPI_QE_SR2_BIT1;
+			break;
+		default:
+			/* Not supported, keep the default sequence */
+			debug("* Unsupported Quad Enable Requirements %d\n", (dw >> 20) & 0x07);
+			break;
+		}
+	}
+}
+
+/*
+ * Read SFDP header and JEDEC Basic Flash Parameter Table, and update
+ * `params` by the table. `params` is kept as is (the default) when
+ * the memory does not have a valid SFDP.
+ */
+bool qspi_sfdp_discover(qspi_sfdp_read_t read, void *arg, struct qspi_mem_params *params)
+{
+	uint8_t header[SFDP_HEADER_BYTE];
+	uint8_t param_header[SFDP_PARAM_HEADER_BYTE];
+	uint8_t bfpt[SFDP_BFPT_DWORD_MAX * sizeof(uint32_t)];
+	uint8_t dw_num;
+	uint32_t bfpt_addr;
+
+	params->is_sfdp = false;
+
+	if (!read(0, header, sizeof(header), arg)) {
+		return false;
+	}
+	if (get_le32(header) != SFDP_SIGNATURE) {
+		debug("* SFDP signature is not found (0x%08x)\n", get_le32(header));
+		return false;
+	}
+
+	/* The first Parameter Header is always JEDEC Basic Flash Parameter */
+	if (!read(SFDP_HEADER_BYTE, param_header, sizeof(param_header), arg)) {
+		return false;
+	}
+	if ((param_header[7] << 8 | param_header[0]) != SFDP_BFPT_ID) {
+		debug("* SFDP Basic Flash Parameter Table is not found\n");
+		return false;
+	}
+
+	dw_num = MIN(param_header[3], SFDP_BFPT_DWORD_MAX);
+	if (dw_num < BFPT_DW_QUAD_READ) {
+		debug("* SFDP Basic Flash Parameter Table is too short (%d DWORD)\n", dw_num);
+		return false;
+	}
+	bfpt_addr = param_header[4] | (param_header[5] << 8) | (param_header[6] << 16);
+
+	if (!read(bfpt_addr, bfpt, dw_num * sizeof(uint32_t), arg)) {
+		return false;
+	}
+
+	parse_bfpt(bfpt, dw_num, params);
+	params->is_sfdp = true;
+
+	return true;
+}
+
+void qspi_mem_params_print(const char *name, const struct qspi_mem_params *params)
+{
+	info("  %s: JEDEC ID %02x-%02x-%02x, %d KB, Page %d byte (%s)\n", name,
+			params->jedec_id[0], params->jedec_id[1], params->jedec_id[2],
+			params->size / 1024, params->page_size, params->is_sfdp ? "SFDP" : "default");
+	info("  %s: Read 0x%02x (%s, mode %d, dummy %d clock), Erase 0x%02x/0x%02x/0x%02x\n",
+			name, params->read_opcode,
+			params->read_mode == QSPI_READ_MODE_1_4_4 ? "1-4-4" : "1-1-4",
+			params->read_mode_clocks, params->read_dummy_clocks,
+			params->erase_opcode[QSPI_ERASE_SECTOR],
+			params->erase_opcode[QSPI_ERASE_HALF_BLOCK],
+			params->erase_opcode[QSPI_ERASE_BLOCK]);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2022 Space Cubics, LLC.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef SCOBCA1_FPGA_TEST_QSPI_SFDP_H_
+#define SCOBCA1_FPGA_TEST_QSPI_SFDP_H_
+
+#include <zephyr/kernel.h>
+#include "qspi_common.h"
+
+#define QSPI_JEDEC_ID_BYTE (3u)
+
+enum QspiReadMode
+{
+	QSPI_READ_MODE_1_4_4,   /* Quad I/O Read */
+	QSPI_READ_MODE_1_1_4,   /* Quad Output Read */
+};
+
+enum QspiQuadEnable
+{
+	QSPI_QE_NONE,           /* No QE bit */
+	QSPI_QE_SR1_BIT6,       /* QE is bit 6 of SR1, write SR1 with 1 byte */
+	QSPI_QE_SR2_BIT1,       /* QE is bit 1 of SR2, write SR1 and SR2 with 2 byte */
+};
+
+/* Memory parameters, discovered by JEDEC ID and SFDP on initialize */
+struct qspi_mem_params {
+	uint8_t jedec_id[QSPI_JEDEC_ID_BYTE];
+	bool is_sfdp;
+	uint32_t size;
+	uint32_t page_size;                           /* 0: no page (FRAM) */
+	enum QspiReadMode read_mode;
+	uint8_t read_opcode;
+	uint8_t read_mode_clocks;
+	uint8_t read_dummy_clocks;
+	uint8_t erase_opcode[QSPI_ERASE_TYPE_NUM];   /* 0x00: not supported */
+	enum QspiQuadEnable quad_enable;
+};
+
+/* Read `size` byte of SFDP from `addr` */
+typedef bool (*qspi_sfdp_read_t)(uint32_t addr, uint8_t *buf, size_t size, void *arg);
+
+bool qspi_sfdp_discover(qspi_sfdp_read_t read, void *arg, struct qspi_mem_params *params);
+void qspi_mem_params_print(const char *name, const struct qspi_mem_params *params);
+
+#endif /* SCOBCA1_FPGA_TEST_QSPI_SFDP_H_ */